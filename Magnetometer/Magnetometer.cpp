@@ -1,11 +1,10 @@
 #include "Magnetometer.h"
-#include <Arduino.h>
 
 Magnetometer::~Magnetometer() {
 }
 
 double Magnetometer::radiansToDegrees(double radians) {
-    return radians * RAD_TO_DEG;
+    return radians * (180.0 / M_PI);
 }
 
 double Magnetometer::computeVectorAngle(int16_t x, int16_t y) {
@@ -13,8 +12,16 @@ double Magnetometer::computeVectorAngle(int16_t x, int16_t y) {
     if (degrees < 0) {
         degrees += 360.0;
     }
-    if (degrees > 360.0) {
+    if (degrees >= 360.0) {
         degrees -= 360.0;
     }
     return degrees;
 }
+
+int16_t Magnetometer::decodeBigEndian(const unsigned char *buf) {
+    return (int16_t) ((buf[0] << 8) | buf[1]);
+}
+
+int16_t Magnetometer::decodeLittleEndian(const unsigned char *buf) {
+    return (int16_t) ((buf[1] << 8) | buf[0]);
+}
@@ -26,16 +26,28 @@ public:
 
     /**
      * Gets the heading in degree.
+     *
+     * Drivers return NAN when the sample could not be read.
      */
     virtual double getHeading() = 0;
 
+    /**
+     * Reads the raw magnetic vector.
+     *
+     * @param x         Where X read will be placed.
+     * @param y         Where Y read will be placed.
+     * @param z         Where Z read will be placed.
+     * @return          True if a whole sample was read.
+     */
+    virtual bool readAxes(int16_t &x, int16_t &y, int16_t &z) = 0;
+
     /**
      * Radians to degrees.
      *
      * @param radians   Radians.
      * @return          Degrees.
      */
-    double inline radiansToDegrees(double radians);
+    static double inline radiansToDegrees(double radians);
 
     /**
      * To convert the micro-Tesla readings into a 0-360 degree compass heading,
@@ -47,7 +59,25 @@ public:
      * @param y         Y read in micro-tesla
      * @return          The heading in degrees.
      */
-    double computeVectorAngle(int16_t x, int16_t y);
+    static double computeVectorAngle(int16_t x, int16_t y);
+
+protected:
+
+    /**
+     * Decodes a 16 bits two's complement value, MSB first.
+     *
+     * @param buf       The 2 bytes, MSB first.
+     * @return          The value.
+     */
+    static int16_t decodeBigEndian(const unsigned char *buf);
+
+    /**
+     * Decodes a 16 bits two's complement value, LSB first.
+     *
+     * @param buf       The 2 bytes, LSB first.
+     * @return          The value.
+     */
+    static int16_t decodeLittleEndian(const unsigned char *buf);
 };
 
 #endif // __ARDUINO_DRIVER_MAGNETOMETER_H__
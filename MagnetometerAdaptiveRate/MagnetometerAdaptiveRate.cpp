@@ -0,0 +1,128 @@
+#include "MagnetometerAdaptiveRate.h"
+
+MagnetometerAdaptiveRate::MagnetometerAdaptiveRate(MagnetometerHMC5883L *magnetometer)
+        : magnetometer(magnetometer), highSpeedCapable(false) {
+    initialize();
+}
+
+MagnetometerAdaptiveRate::MagnetometerAdaptiveRate(MagnetometerHMC5983 *magnetometer)
+        : magnetometer(magnetometer), highSpeedCapable(true) {
+    initialize();
+}
+
+void MagnetometerAdaptiveRate::initialize() {
+    holdSamples = MAGNETOMETER_ADAPTIVE_RATE_DEFAULT_HOLD;
+    cra = 0;
+    mr = 0;
+    clearLevels();
+    addLevel(MagnetometerHMC5883L::DAR_1_5, false, 5, 0);
+    addLevel(MagnetometerHMC5883L::DAR_15, false, 45, 2);
+    addLevel(MagnetometerHMC5883L::DAR_75, false, 0xffff, 20);
+}
+
+void MagnetometerAdaptiveRate::clearLevels() {
+    levelCount = 0;
+    level = 0;
+    slowSamples = 0;
+    lastHeading = 0;
+    rate = 0;
+    started = false;
+}
+
+bool MagnetometerAdaptiveRate::addLevel(unsigned char dataOutputRate, bool highSpeed, uint16_t up, uint16_t down) {
+    if (levelCount >= MAGNETOMETER_ADAPTIVE_RATE_MAX_LEVELS) {
+        return false;
+    }
+    Level *l = &levels[levelCount++];
+    l->dataOutputRate = dataOutputRate;
+    l->highSpeed = highSpeed && highSpeedCapable;
+    l->up = up;
+    l->down = down;
+    return true;
+}
+
+void MagnetometerAdaptiveRate::setHoldSamples(unsigned char samples) {
+    holdSamples = samples;
+}
+
+void MagnetometerAdaptiveRate::begin() {
+    unsigned char configuration[3] = {0};
+    magnetometer->readConfiguration(configuration);
+    cra = configuration[0];
+    mr = configuration[2] & (MAGNETOMETER_HMC5883L_MR_MASK | MAGNETOMETER_HMC5983_MR_LP_MASK | MAGNETOMETER_HMC5983_MR_SIM_MASK
+            | (highSpeedCapable ? MAGNETOMETER_HMC5983_MR_HS_MASK : 0));
+    level = 0;
+    slowSamples = 0;
+    started = false;
+    if (levelCount > 0) {
+        apply();
+    }
+}
+
+void MagnetometerAdaptiveRate::apply() {
+    Level *l = &levels[level];
+    unsigned char newCra = (cra & ~MAGNETOMETER_HMC5883L_CRA_DO_MASK) | (l->dataOutputRate << 2);
+    if (newCra != cra) {
+        cra = newCra;
+        magnetometer->writeRegister(MagnetometerHMC5883L::CRA, cra);
+    }
+    if (highSpeedCapable) {
+        unsigned char newMr = l->highSpeed ? (mr | MAGNETOMETER_HMC5983_MR_HS_MASK) : (mr & ~MAGNETOMETER_HMC5983_MR_HS_MASK);
+        if (newMr != mr) {
+            mr = newMr;
+            magnetometer->writeRegister(MagnetometerHMC5883L::MR, mr);
+        }
+    }
+}
+
+bool MagnetometerAdaptiveRate::update(uint16_t heading, unsigned long dt) {
+    if (!started) {
+        lastHeading = heading;
+        started = true;
+        return false;
+    }
+    int16_t delta = (int16_t) (heading - lastHeading);
+    uint32_t magnitude = delta < 0 ? -(int32_t) delta : delta;
+    unsigned long ticks = dt >> 6;
+    lastHeading = heading;
+
+    // 360 / 65536 degrees per unit over ticks of 64 us: 85.83 degrees per second per unit and tick.
+    uint32_t instant = (magnitude * 86UL) / (ticks > 0 ? ticks : 1);
+    if (instant > 0xffff) {
+        instant = 0xffff;
+    }
+    rate = (uint16_t) ((rate + instant) >> 1);
+
+    unsigned char previous = level;
+    if (level + 1 < levelCount && rate > levels[level].up) {
+        level++;
+        slowSamples = 0;
+    } else if (level > 0 && rate < levels[level].down) {
+        if (++slowSamples >= holdSamples) {
+            level--;
+            slowSamples = 0;
+        }
+    } else {
+        slowSamples = 0;
+    }
+    if (level != previous) {
+        apply();
+        return true;
+    }
+    return false;
+}
+
+bool MagnetometerAdaptiveRate::update(double heading, unsigned long dt) {
+    if (isnan(heading)) {
+        return false;
+    }
+    return update((uint16_t) (long) (heading * (65536.0 / 360.0)), dt);
+}
+
+unsigned char MagnetometerAdaptiveRate::getLevel() {
+    return level;
+}
+
+uint16_t MagnetometerAdaptiveRate::getRate() {
+    return rate;
+}
@@ -0,0 +1,143 @@
+/**
+ * Arduino - MagnetometerAdaptiveRate
+ *
+ * Switches the output rate of the HMC5883L family following the heading dynamics.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_ADAPTIVE_RATE_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_ADAPTIVE_RATE_H__ 1
+
+#include <MagnetometerHMC5883L.h>
+#include <MagnetometerHMC5983.h>
+
+#define MAGNETOMETER_ADAPTIVE_RATE_MAX_LEVELS       4
+#define MAGNETOMETER_ADAPTIVE_RATE_DEFAULT_HOLD     8
+
+/**
+ * A stationary platform does not need 75 Hz, a turning one lags at 1.5 Hz.
+ *
+ * This controller estimates the heading rate of change from successive headings
+ * and moves between a few output rate levels: it steps up as soon as the rate
+ * exceeds the level up threshold, and steps down only after the rate stayed
+ * below the level down threshold for a number of samples (hysteresis).
+ *
+ * CRA and MR are read once in begin() and then kept in shadow registers, so
+ * a level change costs one register write and no read-modify-write.
+ *
+ * <pre>
+ * Default levels:
+ * Level    Rate        Up (deg/s)    Down (deg/s)
+ * 0        1.5 Hz      5             -
+ * 1        15 Hz       45            2
+ * 2        75 Hz       -             20
+ * </pre>
+ *
+ * With an HMC5983, levels may also enable the I2C high speed mode.
+ */
+class MagnetometerAdaptiveRate {
+
+public:
+
+    /**
+     * A rate level.
+     */
+    struct Level {
+        unsigned char dataOutputRate;
+        bool highSpeed;
+        uint16_t up;
+        uint16_t down;
+    };
+
+    /**
+     * Public constructor.
+     *
+     * @param magnetometer      The device.
+     */
+    MagnetometerAdaptiveRate(MagnetometerHMC5883L *magnetometer);
+
+    /**
+     * Public constructor, allowing levels with high speed mode.
+     *
+     * @param magnetometer      The device.
+     */
+    MagnetometerAdaptiveRate(MagnetometerHMC5983 *magnetometer);
+
+    /**
+     * Replaces the default levels. Levels must be added from the slowest to the fastest.
+     */
+    void clearLevels();
+
+    /**
+     * Adds a level.
+     *
+     * @param dataOutputRate    MagnetometerHMC5883L::DataOutputRate option.
+     * @param highSpeed         Enables the HMC5983 I2C high speed mode at this level.
+     * @param up                Rate, in degrees per second, above which the next level is selected.
+     * @param down              Rate, in degrees per second, below which the previous level is selected.
+     * @return                  False if there is no room for another level.
+     */
+    bool addLevel(unsigned char dataOutputRate, bool highSpeed, uint16_t up, uint16_t down);
+
+    /**
+     * Sets how many consecutive slow samples are needed to step down.
+     *
+     * @param samples           Samples.
+     */
+    void setHoldSamples(unsigned char samples);
+
+    /**
+     * Reads CRA and MR into the shadow registers and selects the slowest level.
+     */
+    void begin();
+
+    /**
+     * Feeds a new heading.
+     *
+     * @param heading           Heading, binary angle (65536 == 360 degrees).
+     * @param dt                Time since the previous heading, in microseconds.
+     * @return                  True if the level changed.
+     */
+    bool update(uint16_t heading, unsigned long dt);
+
+    /**
+     * Feeds a new heading.
+     *
+     * @param heading           Heading in degrees. NAN (failed read) is ignored.
+     * @param dt                Time since the previous heading, in microseconds.
+     * @return                  True if the level changed.
+     */
+    bool update(double heading, unsigned long dt);
+
+    /**
+     * Gets the current level.
+     */
+    unsigned char getLevel();
+
+    /**
+     * Gets the estimated heading rate of change, in degrees per second.
+     */
+    uint16_t getRate();
+
+private:
+
+    MagnetometerHMC5883L *magnetometer;
+    bool highSpeedCapable;
+    Level levels[MAGNETOMETER_ADAPTIVE_RATE_MAX_LEVELS];
+    unsigned char levelCount;
+    unsigned char level;
+    unsigned char holdSamples;
+    unsigned char slowSamples;
+    unsigned char cra;
+    unsigned char mr;
+    uint16_t lastHeading;
+    uint16_t rate;
+    bool started;
+
+    void initialize();
+
+    void apply();
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_ADAPTIVE_RATE_H__
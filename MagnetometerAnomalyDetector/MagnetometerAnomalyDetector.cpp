@@ -0,0 +1,134 @@
+#include "MagnetometerAnomalyDetector.h"
+
+static int16_t inclinationRatio(int16_t z, uint32_t magnitude) {
+    int32_t zz = (int32_t) z * (z < 0 ? -z : z);
+    if (magnitude == 0) {
+        return 0;
+    }
+    while (magnitude >= 0x100000UL) {
+        magnitude >>= 1;
+        zz >>= 1;
+    }
+    return (int16_t) ((zz << 10) / (int32_t) magnitude);
+}
+
+MagnetometerAnomalyDetector::MagnetometerAnomalyDetector(Magnetometer *magnetometer)
+        : magnetometer(magnetometer), tolerance(MAGNETOMETER_ANOMALY_DETECTOR_DEFAULT_TOLERANCE),
+          inclinationTolerance(MAGNETOMETER_ANOMALY_DETECTOR_DEFAULT_INCLINATION), relearnAfter(0), overflowMarker(0),
+          checkOverflow(false), status(FIELD_OK), lastHeading(NAN) {
+    reset();
+}
+
+MagnetometerAnomalyDetector::~MagnetometerAnomalyDetector() {
+}
+
+void MagnetometerAnomalyDetector::reset() {
+    expectedMagnitude = 0;
+    expectedInclination = 0;
+    lowerBound = 0;
+    upperBound = 0;
+    learning = MAGNETOMETER_ANOMALY_DETECTOR_DEFAULT_LEARN;
+    anomalies = 0;
+}
+
+void MagnetometerAnomalyDetector::setExpectedField(uint16_t magnitude, double inclination) {
+    double s = sin(inclination * M_PI / 180.0);
+    expectedMagnitude = (uint32_t) magnitude * magnitude;
+    expectedInclination = (int16_t) (s * fabs(s) * 1024.0);
+    learning = 0;
+    anomalies = 0;
+    computeBounds();
+}
+
+void MagnetometerAnomalyDetector::setMagnitudeTolerance(unsigned char tolerance) {
+    this->tolerance = tolerance;
+    computeBounds();
+}
+
+void MagnetometerAnomalyDetector::setInclinationTolerance(int16_t tolerance) {
+    inclinationTolerance = tolerance;
+}
+
+void MagnetometerAnomalyDetector::setRelearnAfter(uint16_t samples) {
+    relearnAfter = samples;
+}
+
+void MagnetometerAnomalyDetector::setOverflowMarker(int16_t marker) {
+    overflowMarker = marker;
+    checkOverflow = true;
+}
+
+void MagnetometerAnomalyDetector::clearOverflowMarker() {
+    checkOverflow = false;
+}
+
+void MagnetometerAnomalyDetector::computeBounds() {
+    uint32_t lower = 256 - tolerance;
+    uint32_t upper = 256 + tolerance;
+    lowerBound = (expectedMagnitude >> 8) * ((lower * lower) >> 8);
+    upperBound = (expectedMagnitude >> 8) * ((upper * upper) >> 8);
+}
+
+void MagnetometerAnomalyDetector::track(uint32_t magnitude, int16_t inclination) {
+    if (expectedMagnitude == 0) {
+        expectedMagnitude = magnitude;
+        expectedInclination = inclination;
+    } else {
+        unsigned char shift = learning > 0 ? 2 : MAGNETOMETER_ANOMALY_DETECTOR_TRACK_SHIFT;
+        expectedMagnitude += (int32_t) (magnitude - expectedMagnitude) >> shift;
+        expectedInclination += (inclination - expectedInclination) >> shift;
+    }
+    computeBounds();
+}
+
+unsigned char MagnetometerAnomalyDetector::check(int16_t x, int16_t y, int16_t z) {
+    if (checkOverflow && (x == overflowMarker || y == overflowMarker || z == overflowMarker)) {
+        status = FIELD_OVERFLOW;
+        return status;
+    }
+    uint32_t magnitude = (uint32_t) ((int32_t) x * x) + (uint32_t) ((int32_t) y * y) + (uint32_t) ((int32_t) z * z);
+    int16_t inclination = inclinationRatio(z, magnitude);
+    status = FIELD_OK;
+    if (learning > 0) {
+        track(magnitude, inclination);
+        learning--;
+        return status;
+    }
+    if (magnitude < lowerBound) {
+        status |= MAGNITUDE_LOW;
+    }
+    if (magnitude > upperBound) {
+        status |= MAGNITUDE_HIGH;
+    }
+    int16_t deviation = inclination - expectedInclination;
+    if (deviation > inclinationTolerance || deviation < -inclinationTolerance) {
+        status |= INCLINATION;
+    }
+    if (status == FIELD_OK) {
+        anomalies = 0;
+        track(magnitude, inclination);
+    } else if (relearnAfter > 0 && ++anomalies >= relearnAfter) {
+        reset();
+    }
+    return status;
+}
+
+unsigned char MagnetometerAnomalyDetector::getStatus() {
+    return status;
+}
+
+bool MagnetometerAnomalyDetector::readAxes(int16_t &x, int16_t &y, int16_t &z) {
+    if (!magnetometer->readAxes(x, y, z)) {
+        status = READ_ERROR;
+        return false;
+    }
+    return check(x, y, z) == FIELD_OK;
+}
+
+double MagnetometerAnomalyDetector::getHeading() {
+    int16_t x = 0, y = 0, z = 0;
+    if (readAxes(x, y, z)) {
+        lastHeading = computeVectorAngle(x, y);
+    }
+    return lastHeading;
+}
@@ -0,0 +1,186 @@
+/**
+ * Arduino - MagnetometerAnomalyDetector
+ *
+ * Flags magnetic disturbances from the field magnitude and inclination.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_ANOMALY_DETECTOR_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_ANOMALY_DETECTOR_H__ 1
+
+#include <Magnetometer.h>
+
+#define MAGNETOMETER_ANOMALY_DETECTOR_DEFAULT_TOLERANCE     38
+#define MAGNETOMETER_ANOMALY_DETECTOR_DEFAULT_INCLINATION   80
+#define MAGNETOMETER_ANOMALY_DETECTOR_DEFAULT_LEARN         16
+#define MAGNETOMETER_ANOMALY_DETECTOR_TRACK_SHIFT           5
+
+/**
+ * The earth field has, at a given place, a nearly constant magnitude and
+ * inclination (dip angle). A nearby motor, speaker or steel structure adds its
+ * own field, changing both, while the heading computed from X and Y alone may
+ * still look plausible.
+ *
+ * This detector wraps any Magnetometer and checks every read vector against the
+ * expected magnitude and inclination. The expectation is learned from the first
+ * samples (or set explicitly) and slowly tracked from the samples judged good,
+ * so the memory and the work per sample are constant.
+ *
+ * The magnitude is compared squared and the inclination as sin(i)*|sin(i)|, so
+ * no square root nor trigonometry is needed per sample.
+ *
+ * Some devices report a saturated axis with a marker value (-4096 on the
+ * HMC5883L). The marker is device specific, so it is only checked once set
+ * with setOverflowMarker().
+ *
+ * While a disturbance lasts, getHeading() keeps returning the last good heading,
+ * NAN before the first one.
+ */
+class MagnetometerAnomalyDetector: public Magnetometer {
+
+    Magnetometer *magnetometer;
+
+    /**
+     * Expected squared magnitude.
+     */
+    uint32_t expectedMagnitude;
+
+    /**
+     * Squared magnitude bounds derived from the expected one.
+     */
+    uint32_t lowerBound;
+    uint32_t upperBound;
+
+    /**
+     * Expected sin(inclination) * |sin(inclination)| in Q10.
+     */
+    int16_t expectedInclination;
+
+    /**
+     * Magnitude tolerance in Q8 (fraction of the magnitude).
+     */
+    unsigned char tolerance;
+
+    /**
+     * Inclination tolerance in Q10.
+     */
+    int16_t inclinationTolerance;
+
+    uint16_t learning;
+    uint16_t anomalies;
+    uint16_t relearnAfter;
+    int16_t overflowMarker;
+    bool checkOverflow;
+    unsigned char status;
+    double lastHeading;
+
+    void computeBounds();
+
+    void track(uint32_t magnitude, int16_t inclination);
+
+public:
+
+    /**
+     * Reasons a sample was rejected.
+     */
+    enum Status {
+        FIELD_OK = 0x00,
+        MAGNITUDE_LOW = 0x01,
+        MAGNITUDE_HIGH = 0x02,
+        INCLINATION = 0x04,
+        FIELD_OVERFLOW = 0x08,
+        READ_ERROR = 0x10
+    };
+
+    /**
+     * Public constructor.
+     *
+     * @param magnetometer      The magnetometer to be watched.
+     */
+    MagnetometerAnomalyDetector(Magnetometer *magnetometer);
+
+    /**
+     * Virtual destructor
+     */
+    virtual ~MagnetometerAnomalyDetector();
+
+    /**
+     * Forgets the expected field and learns it again from the next samples.
+     */
+    void reset();
+
+    /**
+     * Sets the expected field instead of learning it.
+     *
+     * @param magnitude         Field magnitude in raw counts (depends on the gain).
+     * @param inclination       Inclination (dip) angle in degrees, positive pointing down.
+     */
+    void setExpectedField(uint16_t magnitude, double inclination);
+
+    /**
+     * Sets the magnitude tolerance.
+     *
+     * @param tolerance         Fraction of the magnitude, in 1/256 units (38 ~ 15%).
+     */
+    void setMagnitudeTolerance(unsigned char tolerance);
+
+    /**
+     * Sets the inclination tolerance.
+     *
+     * @param tolerance         Tolerance of sin(i)*|sin(i)|, in 1/1024 units.
+     */
+    void setInclinationTolerance(int16_t tolerance);
+
+    /**
+     * Sets after how many consecutive anomalies the field is learned again,
+     * for when the platform really moved to a different field. Zero never relearns.
+     *
+     * @param samples           Consecutive anomalies.
+     */
+    void setRelearnAfter(uint16_t samples);
+
+    /**
+     * Sets the value the device reports for a saturated axis. Samples with
+     * any axis at this value are flagged FIELD_OVERFLOW.
+     *
+     * @param marker            Overflow value, MAGNETOMETER_HMC5883L_OVERFLOW for the HMC5883L and HMC5983.
+     */
+    void setOverflowMarker(int16_t marker);
+
+    /**
+     * Stops checking for an overflow marker (default).
+     */
+    void clearOverflowMarker();
+
+    /**
+     * Checks a sample against the expected field.
+     *
+     * @param x         X read.
+     * @param y         Y read.
+     * @param z         Z read.
+     * @return          FIELD_OK or a combination of Status flags.
+     */
+    unsigned char check(int16_t x, int16_t y, int16_t z);
+
+    /**
+     * Gets the status of the last checked sample.
+     */
+    unsigned char getStatus();
+
+    /**
+     * Reads the vector from the watched magnetometer and checks it.
+     *
+     * @return          True if the sample was read and is not disturbed.
+     */
+    bool readAxes(int16_t &x, int16_t &y, int16_t &z);
+
+    /**
+     * Gets the heading in degree, or the last good one if the field is disturbed.
+     *
+     * @return          The heading, or NAN if no good sample was read yet.
+     */
+    double getHeading();
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_ANOMALY_DETECTOR_H__
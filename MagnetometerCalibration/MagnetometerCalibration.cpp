@@ -0,0 +1,48 @@
+#include "MagnetometerCalibration.h"
+
+static int16_t saturate(int32_t value) {
+    if (value > 32767) {
+        return 32767;
+    }
+    if (value < -32768) {
+        return -32768;
+    }
+    return (int16_t) value;
+}
+
+MagnetometerCalibration::MagnetometerCalibration() {
+    reset();
+}
+
+void MagnetometerCalibration::reset() {
+    for (unsigned char i = 0; i < 3; i++) {
+        parameters.offset[i] = 0;
+    }
+    for (unsigned char i = 0; i < 9; i++) {
+        parameters.matrix[i] = (i % 4 == 0) ? MAGNETOMETER_CALIBRATION_ONE : 0;
+    }
+}
+
+void MagnetometerCalibration::setParameters(const Parameters &parameters) {
+    this->parameters = parameters;
+}
+
+const MagnetometerCalibration::Parameters &MagnetometerCalibration::getParameters() {
+    return parameters;
+}
+
+void MagnetometerCalibration::setOffset(int16_t x, int16_t y, int16_t z) {
+    parameters.offset[0] = x;
+    parameters.offset[1] = y;
+    parameters.offset[2] = z;
+}
+
+void MagnetometerCalibration::apply(int16_t &x, int16_t &y, int16_t &z) {
+    int32_t dx = (int32_t) x - parameters.offset[0];
+    int32_t dy = (int32_t) y - parameters.offset[1];
+    int32_t dz = (int32_t) z - parameters.offset[2];
+    const int16_t *m = parameters.matrix;
+    x = saturate((m[0] * dx + m[1] * dy + m[2] * dz) >> 12);
+    y = saturate((m[3] * dx + m[4] * dy + m[5] * dz) >> 12);
+    z = saturate((m[6] * dx + m[7] * dy + m[8] * dz) >> 12);
+}
@@ -0,0 +1,99 @@
+/**
+ * Arduino - MagnetometerCalibration
+ *
+ * Hard and soft iron correction of raw magnetometer vectors.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_CALIBRATION_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_CALIBRATION_H__ 1
+
+#include <inttypes.h>
+
+#define MAGNETOMETER_CALIBRATION_ONE    4096
+
+/**
+ * Ferrous materials mounted near the sensor distort the field it measures.
+ *
+ * Hard iron (permanently magnetized parts) adds a constant vector, shifting the
+ * sphere described by the readings while the sensor rotates. Soft iron (parts that
+ * bend the earth field) turns that sphere into an ellipsoid.
+ *
+ * Both are removed with:
+ *
+ * <pre>
+ * corrected = M * (raw - offset)
+ * </pre>
+ *
+ * where offset is the ellipsoid center and M, in Q12 (4096 == 1.0), maps the
+ * ellipsoid back into a sphere. Only integer arithmetic is used.
+ */
+class MagnetometerCalibration {
+
+public:
+
+    /**
+     * Calibration parameters, as stored and exported.
+     */
+    struct Parameters {
+
+        /**
+         * Hard iron offset in raw counts, X, Y and Z.
+         */
+        int16_t offset[3];
+
+        /**
+         * Soft iron matrix in Q12, row major.
+         */
+        int16_t matrix[9];
+    };
+
+    /**
+     * Public constructor.
+     *
+     * Starts with no offset and the identity matrix.
+     */
+    MagnetometerCalibration();
+
+    /**
+     * Resets to no offset and the identity matrix.
+     */
+    void reset();
+
+    /**
+     * Sets the calibration parameters.
+     *
+     * @param parameters    Parameters.
+     */
+    void setParameters(const Parameters &parameters);
+
+    /**
+     * Gets the calibration parameters.
+     */
+    const Parameters &getParameters();
+
+    /**
+     * Sets the hard iron offset only.
+     *
+     * @param x         X offset.
+     * @param y         Y offset.
+     * @param z         Z offset.
+     */
+    void setOffset(int16_t x, int16_t y, int16_t z);
+
+    /**
+     * Corrects a raw vector in place.
+     *
+     * @param x         X read.
+     * @param y         Y read.
+     * @param z         Z read.
+     */
+    void apply(int16_t &x, int16_t &y, int16_t &z);
+
+private:
+
+    Parameters parameters;
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_CALIBRATION_H__
@@ -0,0 +1,106 @@
+#include "MagnetometerDecimator.h"
+
+MagnetometerDecimator::MagnetometerDecimator()
+        : stageCount(0) {
+    reset();
+}
+
+void MagnetometerDecimator::reset() {
+    for (unsigned char axis = 0; axis < 3; axis++) {
+        for (unsigned char i = 0; i < MAGNETOMETER_DECIMATOR_ORDER; i++) {
+            integrator[axis][i] = 0;
+        }
+    }
+    for (unsigned char i = 0; i < stageCount; i++) {
+        restart(&stages[i]);
+    }
+}
+
+void MagnetometerDecimator::restart(Stage *stage) {
+    for (unsigned char axis = 0; axis < 3; axis++) {
+        for (unsigned char i = 0; i < MAGNETOMETER_DECIMATOR_ORDER; i++) {
+            stage->comb[axis][i] = 0;
+        }
+        stage->output[axis] = 0;
+    }
+    stage->count = 0;
+
+    // Outputs are only complete once the input filled the whole filter length.
+    stage->settling = stage->ratio > 1 ? MAGNETOMETER_DECIMATOR_ORDER - 1 : 0;
+    stage->ready = false;
+}
+
+int MagnetometerDecimator::addStage(unsigned char ratio) {
+    if (ratio == 0 || ratio > MAGNETOMETER_DECIMATOR_MAX_RATIO || stageCount >= MAGNETOMETER_DECIMATOR_MAX_STAGES) {
+        return -1;
+    }
+    stages[stageCount].ratio = ratio;
+    stages[stageCount].gain = (uint32_t) ratio * ratio * ratio;
+    stageCount++;
+    reset();
+    return stageCount - 1;
+}
+
+unsigned char MagnetometerDecimator::getStageCount() {
+    return stageCount;
+}
+
+unsigned char MagnetometerDecimator::getRatio(unsigned char stage) {
+    return stage < stageCount ? stages[stage].ratio : 0;
+}
+
+unsigned char MagnetometerDecimator::push(int16_t x, int16_t y, int16_t z) {
+    int16_t input[3] = {x, y, z};
+    unsigned char updated = 0;
+    for (unsigned char axis = 0; axis < 3; axis++) {
+        uint32_t v = (uint32_t) (int32_t) input[axis];
+        for (unsigned char i = 0; i < MAGNETOMETER_DECIMATOR_ORDER; i++) {
+            integrator[axis][i] += v;
+            v = integrator[axis][i];
+        }
+    }
+    for (unsigned char s = 0; s < stageCount; s++) {
+        Stage *stage = &stages[s];
+        if (++stage->count < stage->ratio) {
+            continue;
+        }
+        stage->count = 0;
+        for (unsigned char axis = 0; axis < 3; axis++) {
+            uint32_t v = integrator[axis][MAGNETOMETER_DECIMATOR_ORDER - 1];
+            for (unsigned char i = 0; i < MAGNETOMETER_DECIMATOR_ORDER; i++) {
+                uint32_t delayed = stage->comb[axis][i];
+                stage->comb[axis][i] = v;
+                v -= delayed;
+            }
+
+            // The wrapped difference is exact: |v| < 32768 * gain < 2^31.
+            int32_t sum = (int32_t) v;
+            int32_t half = (int32_t) (stage->gain >> 1);
+            sum = (sum < 0 ? sum - half : sum + half) / (int32_t) stage->gain;
+            stage->output[axis] = (int16_t) sum;
+        }
+        if (stage->settling > 0) {
+            stage->settling--;
+            continue;
+        }
+        stage->ready = true;
+        updated |= 1 << s;
+    }
+    return updated;
+}
+
+bool MagnetometerDecimator::available(unsigned char stage) {
+    return stage < stageCount && stages[stage].ready;
+}
+
+bool MagnetometerDecimator::read(unsigned char stage, int16_t &x, int16_t &y, int16_t &z) {
+    if (stage >= stageCount) {
+        return false;
+    }
+    bool fresh = stages[stage].ready;
+    x = stages[stage].output[0];
+    y = stages[stage].output[1];
+    z = stages[stage].output[2];
+    stages[stage].ready = false;
+    return fresh;
+}
@@ -0,0 +1,140 @@
+/**
+ * Arduino - MagnetometerDecimator
+ *
+ * Fixed-point CIC decimation of one sample stream into several output rates.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_DECIMATOR_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_DECIMATOR_H__ 1
+
+#include <inttypes.h>
+
+#define MAGNETOMETER_DECIMATOR_MAX_STAGES       4
+#define MAGNETOMETER_DECIMATOR_ORDER            3
+#define MAGNETOMETER_DECIMATOR_MAX_RATIO        40
+
+/**
+ * Runs the sensor at its highest rate (220 Hz on the HMC5983) and derives from
+ * that single stream several outputs, each at its own lower rate and lower
+ * noise. For instance, every sample for a control loop and 10 Hz for a display:
+ *
+ * <pre>
+ * MagnetometerDecimator decimator;
+ * decimator.addStage(1);       // 220 Hz, raw
+ * decimator.addStage(22);      // 10 Hz, low noise
+ * </pre>
+ *
+ * Each output is a third order CIC (cascaded integrator-comb) filter, that is
+ * a moving average of the input applied three times, computed with additions
+ * only:
+ *
+ * <pre>
+ * Input rate:      3 integrators per axis, shared by all outputs.
+ * Output rate:     3 combs per axis and output, then a division by ratio^3.
+ * </pre>
+ *
+ * The integrators are allowed to wrap around: modulo 2^32 arithmetic gives the
+ * exact result as long as ratio^3 * 32768 fits 31 bits, which bounds the ratio
+ * to 40. Since all outputs see the same input, the integrators run once per
+ * sample whatever the number of outputs, and the bus is read once per sample.
+ *
+ * The response has nulls at multiples of the output rate, so anything that
+ * would alias below a quarter of the output rate is attenuated by at least
+ * 30 dB. The passband droops (about -3 dB at a quarter of the output rate),
+ * which is harmless for headings. The first outputs after a reset are dropped
+ * until the filter is filled.
+ */
+class MagnetometerDecimator {
+
+    struct Stage {
+
+        /**
+         * Comb delays, per axis.
+         */
+        uint32_t comb[3][MAGNETOMETER_DECIMATOR_ORDER];
+
+        /**
+         * DC gain, ratio^3.
+         */
+        uint32_t gain;
+        int16_t output[3];
+        unsigned char ratio;
+        unsigned char count;
+        unsigned char settling;
+        bool ready;
+    };
+
+    /**
+     * Integrators, per axis.
+     */
+    uint32_t integrator[3][MAGNETOMETER_DECIMATOR_ORDER];
+
+    Stage stages[MAGNETOMETER_DECIMATOR_MAX_STAGES];
+    unsigned char stageCount;
+
+    void restart(Stage *stage);
+
+public:
+
+    /**
+     * Public constructor.
+     */
+    MagnetometerDecimator();
+
+    /**
+     * Clears the filters of all outputs. Outputs are kept.
+     */
+    void reset();
+
+    /**
+     * Adds an output, clearing the filters.
+     *
+     * @param ratio     How many input samples per output sample, 1 to 40. One passes the input through.
+     * @return          The output index, or -1 if the ratio is invalid or there are no more outputs.
+     */
+    int addStage(unsigned char ratio);
+
+    /**
+     * Gets how many outputs were added.
+     */
+    unsigned char getStageCount();
+
+    /**
+     * Gets the decimation ratio of an output.
+     *
+     * @param stage     Output index.
+     */
+    unsigned char getRatio(unsigned char stage);
+
+    /**
+     * Feeds an input sample.
+     *
+     * @param x         X read.
+     * @param y         Y read.
+     * @param z         Z read.
+     * @return          A mask with bit i set if output i has a new sample.
+     */
+    unsigned char push(int16_t x, int16_t y, int16_t z);
+
+    /**
+     * Gets whether an output has a sample not read yet.
+     *
+     * @param stage     Output index.
+     */
+    bool available(unsigned char stage);
+
+    /**
+     * Reads the last sample of an output.
+     *
+     * @param stage     Output index.
+     * @param x         X output.
+     * @param y         Y output.
+     * @param z         Z output.
+     * @return          True if the sample was not read before.
+     */
+    bool read(unsigned char stage, int16_t &x, int16_t &y, int16_t &z);
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_DECIMATOR_H__
@@ -0,0 +1,58 @@
+#include <Wire.h>
+#include <Magnetometer.h>
+#include <WiredDevice.h>
+#include <RegisterBasedWiredDevice.h>
+#include <MagnetometerHMC5883L.h>
+#include <MagnetometerHMC5983.h>
+#include <MagnetometerDecimator.h>
+
+/**
+ * Pinout
+ *
+ * <pre>
+ * Sensor   -> Arduino
+ * -------------------
+ * SCL      -> A5
+ * SDA      -> A4
+ *
+ * VCC      -> 3v3
+ * GND      -> GND
+ * </pre>
+ */
+
+MagnetometerHMC5983 mag;
+MagnetometerDecimator decimator;
+
+int control;
+int display;
+
+void setup() {
+    Serial.begin(115200);
+    Wire.begin();
+    Wire.setClock(400000);
+    mag.setSamplesAveraged(MagnetometerHMC5883L::SA_1);
+    mag.setDataOutputRate(MagnetometerHMC5983::DAR_220);
+    mag.setOperatingMode(MagnetometerHMC5883L::CONTINUOUS_MEASUREMENT_MODE);
+
+    // 220 Hz for the control loop, 10 Hz low noise for the display.
+    control = decimator.addStage(1);
+    display = decimator.addStage(22);
+}
+
+void loop() {
+    int16_t x, y, z;
+    if (!mag.getStatusRegister().RDY || !mag.readAxes(x, y, z)) {
+        return;
+    }
+    unsigned char updated = decimator.push(x, y, z);
+    if (updated & (1 << control)) {
+        decimator.read(control, x, y, z);
+
+        // Fast, noisy heading for the control loop.
+    }
+    if (updated & (1 << display)) {
+        decimator.read(display, x, y, z);
+        Serial.print("heading: ");
+        Serial.println(Magnetometer::computeVectorAngle(x, y));
+    }
+}
@@ -0,0 +1,100 @@
+#include "MagnetometerDetector.h"
+#include <string.h>
+#include <RegisterBasedWiredDevice.h>
+#include <MagnetometerHMC5883L.h>
+#include <MagnetometerQMC5883L.h>
+#include <MagnetometerLIS3MDL.h>
+#include <MagnetometerMMC5883MA.h>
+
+static const unsigned char HMC5883L_IDENTIFICATION[3] = {'H', '4', '3'};
+static const unsigned char LIS3MDL_IDENTIFICATION[1] = {MAGNETOMETER_LIS3MDL_WHO_AM_I};
+static const unsigned char QMC5883L_IDENTIFICATION[1] = {MAGNETOMETER_QMC5883L_CHIP_ID};
+static const unsigned char MMC5883MA_IDENTIFICATION[1] = {MAGNETOMETER_MMC5883MA_PRODUCT_ID};
+
+MagnetometerDetector::MagnetometerDetector()
+        : chip(UNKNOWN_CHIP), address(0), magnetometer(0) {
+}
+
+bool MagnetometerDetector::probe(unsigned char address, unsigned char reg, const unsigned char *expected, int len) {
+    RegisterBasedWiredDevice device(address);
+    unsigned char buf[3] = {0};
+    if (device.readRegisterBlock(reg, buf, len) != len) {
+        return false;
+    }
+    return memcmp(buf, expected, len) == 0;
+}
+
+MagnetometerDetector::Chip MagnetometerDetector::detect() {
+    chip = UNKNOWN_CHIP;
+    address = 0;
+    magnetometer = 0;
+    if (probe(MAGNETOMETER_HMC5883L_DEVICE_ADDRESS, MagnetometerHMC5883L::IDA, HMC5883L_IDENTIFICATION, 3)) {
+        chip = HMC5883L_CHIP;
+        address = MAGNETOMETER_HMC5883L_DEVICE_ADDRESS;
+    } else if (probe(MAGNETOMETER_LIS3MDL_DEVICE_ADDRESS, MagnetometerLIS3MDL::WHO_AM_I, LIS3MDL_IDENTIFICATION, 1)) {
+        chip = LIS3MDL_CHIP;
+        address = MAGNETOMETER_LIS3MDL_DEVICE_ADDRESS;
+    } else if (probe(MAGNETOMETER_LIS3MDL_ALTERNATE_ADDRESS, MagnetometerLIS3MDL::WHO_AM_I, LIS3MDL_IDENTIFICATION, 1)) {
+        chip = LIS3MDL_CHIP;
+        address = MAGNETOMETER_LIS3MDL_ALTERNATE_ADDRESS;
+    } else if (probe(MAGNETOMETER_QMC5883L_DEVICE_ADDRESS, MagnetometerQMC5883L::CHIP_ID, QMC5883L_IDENTIFICATION, 1)) {
+        chip = QMC5883L_CHIP;
+        address = MAGNETOMETER_QMC5883L_DEVICE_ADDRESS;
+    } else if (probe(MAGNETOMETER_MMC5883MA_DEVICE_ADDRESS, MagnetometerMMC5883MA::PRODUCT_ID, MMC5883MA_IDENTIFICATION, 1)) {
+        chip = MMC5883MA_CHIP;
+        address = MAGNETOMETER_MMC5883MA_DEVICE_ADDRESS;
+    }
+    return chip;
+}
+
+MagnetometerDetector::Chip MagnetometerDetector::getChip() {
+    return chip;
+}
+
+unsigned char MagnetometerDetector::getAddress() {
+    return address;
+}
+
+Magnetometer *MagnetometerDetector::getMagnetometer() {
+    if (magnetometer != 0) {
+        return magnetometer;
+    }
+    switch (chip) {
+    case HMC5883L_CHIP: {
+        static MagnetometerHMC5883L hmc;
+        hmc.setDataOutputRate(MagnetometerHMC5883L::DAR_75);
+        hmc.setOperatingMode(MagnetometerHMC5883L::CONTINUOUS_MEASUREMENT_MODE);
+        magnetometer = &hmc;
+        break;
+    }
+    case QMC5883L_CHIP: {
+        static MagnetometerQMC5883L qmc;
+        qmc.reset();
+        qmc.setOverSampleRatio(MagnetometerQMC5883L::OSR_512);
+        qmc.setFullScale(MagnetometerQMC5883L::RANGE_8_GA);
+        qmc.setDataOutputRate(MagnetometerQMC5883L::DAR_200);
+        qmc.setOperatingMode(MagnetometerQMC5883L::CONTINUOUS_MEASUREMENT_MODE);
+        magnetometer = &qmc;
+        break;
+    }
+    case LIS3MDL_CHIP: {
+        static MagnetometerLIS3MDL lis(address);
+        lis.setBlockDataUpdate(true);
+        lis.setPerformanceMode(MagnetometerLIS3MDL::HIGH_PERFORMANCE_MODE);
+        lis.setDataOutputRate(MagnetometerLIS3MDL::DAR_80);
+        lis.setOperatingMode(MagnetometerLIS3MDL::CONTINUOUS_MEASUREMENT_MODE);
+        magnetometer = &lis;
+        break;
+    }
+    case MMC5883MA_CHIP: {
+        static MagnetometerMMC5883MA mmc;
+        mmc.performSet();
+        mmc.setContinuousMeasurementFrequency(MagnetometerMMC5883MA::CM_14_HZ);
+        magnetometer = &mmc;
+        break;
+    }
+    default:
+        break;
+    }
+    return magnetometer;
+}
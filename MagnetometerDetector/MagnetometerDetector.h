@@ -0,0 +1,93 @@
+/**
+ * Arduino - MagnetometerDetector
+ *
+ * Detects which magnetometer chip is on the bus and dispatches to its driver.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_DETECTOR_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_DETECTOR_H__ 1
+
+#include <Magnetometer.h>
+
+/**
+ * Boards sold with the same footprint carry different chips: the genuine
+ * HMC5883L (or its HMC5983 successor), the QMC5883L clone, the LIS3MDL or the
+ * MMC5883MA. They answer at different addresses (or at the same one, for the
+ * LIS3MDL and the HMC5883L) and each one has identification registers:
+ *
+ * <pre>
+ * Chip         Address     Register        Value
+ * HMC5883L     0x1e        IDA..IDC 0x0a   "H43"
+ * LIS3MDL      0x1e/0x1c   WHO_AM_I 0x0f   0x3d
+ * QMC5883L     0x0d        CHIP_ID  0x0d   0xff
+ * MMC5883MA    0x30        PRODUCT  0x2f   0x0c
+ * </pre>
+ *
+ * detect() probes them once at startup. getMagnetometer() then returns the
+ * matching driver, configured for continuous measurement at its highest plain
+ * output rate, behind the common Magnetometer interface. The drivers are
+ * statically allocated and only the detected one is ever constructed.
+ */
+class MagnetometerDetector {
+
+public:
+
+    /**
+     * Supported chips.
+     */
+    enum Chip {
+        UNKNOWN_CHIP = 0x00,
+        HMC5883L_CHIP = 0x01,
+        QMC5883L_CHIP = 0x02,
+        LIS3MDL_CHIP = 0x03,
+        MMC5883MA_CHIP = 0x04
+    };
+
+    /**
+     * Public constructor.
+     */
+    MagnetometerDetector();
+
+    /**
+     * Probes the bus for a supported chip.
+     *
+     * @return          The detected chip, UNKNOWN_CHIP if none answered.
+     */
+    Chip detect();
+
+    /**
+     * Gets the detected chip.
+     */
+    Chip getChip();
+
+    /**
+     * Gets the detected chip address.
+     */
+    unsigned char getAddress();
+
+    /**
+     * Gets the driver of the detected chip, configured for continuous measurement.
+     *
+     * <pre>
+     * HMC5883L     75 Hz
+     * QMC5883L     200 Hz, ±8G, OSR 512
+     * LIS3MDL      80 Hz, high performance, block data update
+     * MMC5883MA    14 Hz
+     * </pre>
+     *
+     * @return          The driver, or 0 if no chip was detected.
+     */
+    Magnetometer *getMagnetometer();
+
+private:
+
+    Chip chip;
+    unsigned char address;
+    Magnetometer *magnetometer;
+
+    static bool probe(unsigned char address, unsigned char reg, const unsigned char *expected, int len);
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_DETECTOR_H__
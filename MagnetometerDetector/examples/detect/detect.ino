@@ -0,0 +1,49 @@
+#include <Wire.h>
+#include <Magnetometer.h>
+#include <WiredDevice.h>
+#include <RegisterBasedWiredDevice.h>
+#include <MagnetometerHMC5883L.h>
+#include <MagnetometerQMC5883L.h>
+#include <MagnetometerLIS3MDL.h>
+#include <MagnetometerMMC5883MA.h>
+#include <MagnetometerDetector.h>
+
+/**
+ * Pinout
+ *
+ * <pre>
+ * Sensor   -> Arduino
+ * -------------------
+ * SCL      -> A5
+ * SDA      -> A4
+ *
+ * VCC      -> 3v3
+ * GND      -> GND
+ * </pre>
+ */
+
+MagnetometerDetector detector;
+Magnetometer *mag;
+
+void setup() {
+    Serial.begin(9600);
+    Wire.begin();
+    Serial.print("Detected chip: ");
+    Serial.println(detector.detect());
+    mag = detector.getMagnetometer();
+}
+
+void loop() {
+    int16_t x, y, z;
+    if (mag != 0 && mag->readAxes(x, y, z)) {
+        Serial.print("x: ");
+        Serial.print(x);
+        Serial.print(" y: ");
+        Serial.print(y);
+        Serial.print(" z: ");
+        Serial.println(z);
+        Serial.print("heading: ");
+        Serial.println(Magnetometer::computeVectorAngle(x, y));
+    }
+    delay(1000);
+}
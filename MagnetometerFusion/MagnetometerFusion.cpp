@@ -0,0 +1,101 @@
+#include "MagnetometerFusion.h"
+
+#define MAGNETOMETER_FUSION_FULL_TURN   4294967296.0
+
+MagnetometerFusion::MagnetometerFusion()
+        : correctionShift(MAGNETOMETER_FUSION_DEFAULT_CORRECTION_SHIFT), biasShift(MAGNETOMETER_FUSION_DEFAULT_BIAS_SHIFT) {
+    setGyroSensitivity(14.375);
+    reset();
+}
+
+void MagnetometerFusion::reset() {
+    heading = 0;
+    gyroBias = 0;
+    elapsed = 0;
+    gravity[0] = gravity[1] = gravity[2] = 0;
+    initialized = false;
+    hasGravity = false;
+}
+
+void MagnetometerFusion::setGyroSensitivity(double lsbPerDegreePerSecond) {
+    gyroFactor = (int32_t) (MAGNETOMETER_FUSION_FULL_TURN / 360.0 / 1000000.0 * 65536.0 / lsbPerDegreePerSecond);
+}
+
+void MagnetometerFusion::setCorrectionShift(unsigned char shift) {
+    correctionShift = shift;
+}
+
+void MagnetometerFusion::setBiasShift(unsigned char shift) {
+    biasShift = shift;
+}
+
+void MagnetometerFusion::updateGyro(int16_t rate, uint32_t dt) {
+    int64_t delta = ((int64_t) rate * dt * gyroFactor) >> 16;
+    delta -= ((int64_t) gyroBias * dt) >> 10;
+    heading += (uint32_t) delta;
+    if (elapsed < 0x80000000UL) {
+        elapsed += dt;
+    }
+}
+
+void MagnetometerFusion::updateMagnetometer(double degrees) {
+    if (isnan(degrees)) {
+        return;
+    }
+    double turn = degrees * (MAGNETOMETER_FUSION_FULL_TURN / 360.0);
+    uint32_t magnetic = (turn >= MAGNETOMETER_FUSION_FULL_TURN || turn < 0.0) ? 0 : (uint32_t) turn;
+    if (!initialized) {
+        heading = magnetic;
+        elapsed = 0;
+        initialized = true;
+        return;
+    }
+    int32_t error = (int32_t) (magnetic - heading);
+    heading += (uint32_t) (error >> correctionShift);
+    if (biasShift > 0 && elapsed > 0) {
+        int64_t rateError = ((int64_t) error << 10) / (int64_t) elapsed;
+        gyroBias -= (int32_t) (rateError >> biasShift);
+    }
+    elapsed = 0;
+}
+
+void MagnetometerFusion::updateMagnetometer(int16_t x, int16_t y, int16_t z) {
+    if (!hasGravity) {
+        updateMagnetometer(Magnetometer::computeVectorAngle(x, y));
+        return;
+    }
+    double roll = atan2(gravity[1], gravity[2]);
+    double sinRoll = sin(roll);
+    double cosRoll = cos(roll);
+    double pitch = atan2(-gravity[0], gravity[1] * sinRoll + gravity[2] * cosRoll);
+    double sinPitch = sin(pitch);
+    double cosPitch = cos(pitch);
+    double xh = x * cosPitch + y * sinPitch * sinRoll + z * sinPitch * cosRoll;
+    double yh = y * cosRoll - z * sinRoll;
+    updateMagnetometer(Magnetometer::computeVectorAngle((int16_t) xh, (int16_t) yh));
+}
+
+void MagnetometerFusion::updateAccelerometer(int16_t x, int16_t y, int16_t z) {
+    if (!hasGravity) {
+        gravity[0] = x;
+        gravity[1] = y;
+        gravity[2] = z;
+        hasGravity = true;
+        return;
+    }
+    gravity[0] += (x - gravity[0]) >> MAGNETOMETER_FUSION_GRAVITY_FILTER_SHIFT;
+    gravity[1] += (y - gravity[1]) >> MAGNETOMETER_FUSION_GRAVITY_FILTER_SHIFT;
+    gravity[2] += (z - gravity[2]) >> MAGNETOMETER_FUSION_GRAVITY_FILTER_SHIFT;
+}
+
+double MagnetometerFusion::getHeading() {
+    return heading * (360.0 / MAGNETOMETER_FUSION_FULL_TURN);
+}
+
+uint16_t MagnetometerFusion::getBinaryAngle() {
+    return (uint16_t) (heading >> 16);
+}
+
+bool MagnetometerFusion::isInitialized() {
+    return initialized;
+}
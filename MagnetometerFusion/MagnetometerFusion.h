@@ -0,0 +1,164 @@
+/**
+ * Arduino - MagnetometerFusion
+ *
+ * Fixed-point complementary filter fusing magnetometer heading with gyro rate.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_FUSION_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_FUSION_H__ 1
+
+#include <Magnetometer.h>
+
+#define MAGNETOMETER_FUSION_DEFAULT_CORRECTION_SHIFT    3
+#define MAGNETOMETER_FUSION_DEFAULT_BIAS_SHIFT          6
+#define MAGNETOMETER_FUSION_GRAVITY_FILTER_SHIFT        2
+
+/**
+ * The magnetometer gives an absolute but noisy and slowly updated heading, while
+ * a gyro gives a smooth, fast but drifting rate of turn. This filter integrates
+ * the gyro rate at the gyro sample rate and pulls the result towards the
+ * magnetometer heading whenever a new magnetometer sample is available.
+ *
+ * The heading is kept as a 32 bits binary angle (2^32 == 360 degrees) so that
+ * wraparound is handled by the integer arithmetic itself. Gyro samples only cost
+ * one multiplication and one shift; trigonometry is only needed when a new
+ * magnetometer vector is fed, at the magnetometer output rate.
+ *
+ * <pre>
+ * Gyro update:         heading += (rate - bias) * dt
+ * Magnetometer update: error = magnetic - heading
+ *                      heading += error >> correctionShift
+ *                      bias -= (error / elapsed) >> biasShift
+ * </pre>
+ *
+ * An optional accelerometer can be fed to tilt compensate the magnetometer vector.
+ */
+class MagnetometerFusion {
+
+    /**
+     * Fused heading, binary angle (2^32 == 360 degrees).
+     */
+    uint32_t heading;
+
+    /**
+     * Binary angle units per gyro LSB per microsecond, in Q16.
+     */
+    int32_t gyroFactor;
+
+    /**
+     * Estimated gyro bias, in binary angle units per 1024 microseconds.
+     */
+    int32_t gyroBias;
+
+    /**
+     * Microseconds integrated from gyro since the last magnetometer update.
+     */
+    uint32_t elapsed;
+
+    /**
+     * Low-passed gravity vector from the accelerometer.
+     */
+    int16_t gravity[3];
+
+    unsigned char correctionShift;
+    unsigned char biasShift;
+    bool initialized;
+    bool hasGravity;
+
+public:
+
+    /**
+     * Public constructor.
+     *
+     * The gyro sensitivity defaults to 14.375 LSB/(degree/s) (ITG-3200).
+     */
+    MagnetometerFusion();
+
+    /**
+     * Forgets the fused heading, the gyro bias and the gravity vector.
+     * The next magnetometer update seeds the heading.
+     */
+    void reset();
+
+    /**
+     * Sets the gyro sensitivity.
+     *
+     * @param lsbPerDegreePerSecond     Gyro LSB per degree per second.
+     */
+    void setGyroSensitivity(double lsbPerDegreePerSecond);
+
+    /**
+     * Sets how much of the magnetometer error is applied at each magnetometer update.
+     * The heading moves 1/2^shift of the error. Higher values trust the gyro more.
+     *
+     * @param shift     Correction shift.
+     */
+    void setCorrectionShift(unsigned char shift);
+
+    /**
+     * Sets how fast the gyro bias is learned from the magnetometer error.
+     * Zero disables bias estimation.
+     *
+     * @param shift     Bias shift.
+     */
+    void setBiasShift(unsigned char shift);
+
+    /**
+     * Integrates a gyro sample.
+     *
+     * The rate must be the one around the vertical axis, positive when the heading
+     * increases (clockwise seen from above). Right-handed, Z up gyros must be negated.
+     *
+     * @param rate      Raw gyro rate.
+     * @param dt        Time since the previous gyro sample in microseconds.
+     */
+    void updateGyro(int16_t rate, uint32_t dt);
+
+    /**
+     * Corrects the fused heading with a magnetometer heading.
+     *
+     * @param heading   Magnetic heading in degrees, as returned by Magnetometer::getHeading().
+     *                  NAN (failed read) is ignored.
+     */
+    void updateMagnetometer(double heading);
+
+    /**
+     * Corrects the fused heading with a raw magnetometer vector.
+     *
+     * If an accelerometer was fed, the vector is tilt compensated before the heading is computed.
+     * The accelerometer axes must be aligned with the magnetometer ones.
+     *
+     * @param x         X read.
+     * @param y         Y read.
+     * @param z         Z read.
+     */
+    void updateMagnetometer(int16_t x, int16_t y, int16_t z);
+
+    /**
+     * Feeds an accelerometer sample used for tilt compensation.
+     *
+     * @param x         X read.
+     * @param y         Y read.
+     * @param z         Z read.
+     */
+    void updateAccelerometer(int16_t x, int16_t y, int16_t z);
+
+    /**
+     * Gets the fused heading in degree.
+     */
+    double getHeading();
+
+    /**
+     * Gets the fused heading as a 16 bits binary angle (65536 == 360 degrees).
+     */
+    uint16_t getBinaryAngle();
+
+    /**
+     * Gets whether a magnetometer sample has already seeded the heading.
+     */
+    bool isInitialized();
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_FUSION_H__
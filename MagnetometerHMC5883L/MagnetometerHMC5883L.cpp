@@ -8,11 +8,10 @@ MagnetometerHMC5883L::~MagnetometerHMC5883L() {
 }
 
 double MagnetometerHMC5883L::getHeading() {
-    unsigned char buf[6];
-    int16_t x = 0, y = 0;
-    readSample(buf);
-    x = (buf[0] << 8) | buf[1];
-    y = (buf[4] << 8) | buf[5];
+    int16_t x = 0, y = 0, z = 0;
+    if (!readAxes(x, y, z)) {
+        return NAN;
+    }
     return computeVectorAngle(x, y);
 }
 
@@ -44,7 +43,30 @@ MagnetometerHMC5883L::SRbits MagnetometerHMC5883L::getStatusRegister() {
     return sr;
 }
 
+int MagnetometerHMC5883L::readConfiguration(unsigned char buf[3]) {
+    return readRegisterBlock(CRA, buf, 0x03);
+}
+
+void MagnetometerHMC5883L::writeConfiguration(unsigned char buf[3]) {
+    writeRegisterBlock(CRA, buf, 0x03);
+}
+
+void MagnetometerHMC5883L::maskConfiguration(unsigned char buf[3]) {
+    buf[0] &= MAGNETOMETER_HMC5883L_CRA_MASK;
+    buf[1] &= MAGNETOMETER_HMC5883L_CRB_GN_MASK;
+    buf[2] &= MAGNETOMETER_HMC5883L_MR_MASK;
+}
+
 int MagnetometerHMC5883L::readSample(unsigned char buf[6]) {
     return readRegisterBlock(DXRA, buf, 0x06);
 }
 
+bool MagnetometerHMC5883L::readAxes(int16_t &x, int16_t &y, int16_t &z) {
+    unsigned char buf[6] = {0};
+    int n = readSample(buf);
+    x = decodeBigEndian(&buf[0]);
+    z = decodeBigEndian(&buf[2]);
+    y = decodeBigEndian(&buf[4]);
+    return n == 6;
+}
+
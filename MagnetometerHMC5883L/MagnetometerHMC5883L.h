@@ -13,11 +13,15 @@
 #include <RegisterBasedWiredDevice.h>
 
 #define MAGNETOMETER_HMC5883L_DEVICE_ADDRESS    0x1e
+#define MAGNETOMETER_HMC5883L_OVERFLOW          -4096
 
+#define MAGNETOMETER_HMC5883L_CRA_MASK          0x7f
 #define MAGNETOMETER_HMC5883L_CRA_MS_MASK       0x60
 #define MAGNETOMETER_HMC5883L_CRA_DO_MASK       0x1c
 #define MAGNETOMETER_HMC5883L_CRA_MA_MASK       0x03
 
+#define MAGNETOMETER_HMC5883L_CRB_GN_MASK       0xe0
+
 #define MAGNETOMETER_HMC5883L_MR_MASK           0x03
 
 /**
@@ -508,6 +512,37 @@ public:
      */
     SRbits getStatusRegister();
 
+    /**
+     * Reads the configuration.
+     *
+     * Reads CRA, CRB and MR in a single burst. Note that reading the mode register sets
+     * the LOCK bit until the data output registers are read or the mode register is changed.
+     *
+     * @param   buf     Where CRA, CRB and MR will be placed.
+     * @return          The number of bytes read.
+     */
+    int readConfiguration(unsigned char buf[3]);
+
+    /**
+     * Writes the configuration.
+     *
+     * Writes CRA, CRB and MR in a single burst, relying on the register pointer auto increment.
+     * Writing the mode register also clears the LOCK bit.
+     *
+     * @param   buf     CRA, CRB and MR values.
+     */
+    void writeConfiguration(unsigned char buf[3]);
+
+    /**
+     * Clears the bits of a read configuration that must be written as 0.
+     *
+     * CRA7, CRB4 to CRB0 and MR7 to MR2 (MR7 is set internally after each single measurement),
+     * so the configuration can be written back as is.
+     *
+     * @param   buf     CRA, CRB and MR values.
+     */
+    virtual void maskConfiguration(unsigned char buf[3]);
+
     /**
      * Reads the sample.
      *
@@ -518,8 +553,22 @@ public:
      */
     int readSample(unsigned char buf[6]);
 
+    /**
+     * Reads the sample and decodes it into the three axes.
+     *
+     * The data output registers are ordered X, Z, Y.
+     *
+     * @param x         Where X read will be placed.
+     * @param y         Where Y read will be placed.
+     * @param z         Where Z read will be placed.
+     * @return          True if all 6 bytes were read.
+     */
+    bool readAxes(int16_t &x, int16_t &y, int16_t &z);
+
     /**
      * Gets the heading in degree.
+     *
+     * @return          The heading, or NAN if the sample could not be read.
      */
     double getHeading();
 };
@@ -3,6 +3,11 @@
 MagnetometerHMC5983::MagnetometerHMC5983() {
 }
 
+void MagnetometerHMC5983::maskConfiguration(unsigned char buf[3]) {
+    buf[1] &= MAGNETOMETER_HMC5883L_CRB_GN_MASK;
+    buf[2] &= MAGNETOMETER_HMC5983_MR_MASK;
+}
+
 void MagnetometerHMC5983::setTemperatureSensor(unsigned char temperatureSensor) {
     configureRegisterBits(CRA, 0x80, temperatureSensor << 7);
 }
@@ -15,6 +15,7 @@
 #define MAGNETOMETER_HMC5983_MR_LP_MASK         0x20
 #define MAGNETOMETER_HMC5983_MR_SIM_MASK        0x04
 #define MAGNETOMETER_HMC5983_SR_DOW_MASK        0x10
+#define MAGNETOMETER_HMC5983_MR_MASK            0x27
 
 /**
  * The same as MagnetometerHMC5883L but with temperature sensor.
@@ -138,6 +139,13 @@ public:
         unsigned char value;
     };
 
+    /**
+     * Extended data output rate (CRA DO 111), continuous measurement mode only.
+     */
+    enum ExtendedDataOutputRate {
+        DAR_220 = 0x07
+    };
+
     /**
      * Speed mode.
      */
@@ -185,6 +193,17 @@ public:
      */
     void setTemperatureSensor(unsigned char temperatureSensor);
 
+    /**
+     * Clears the bits of a read configuration that must be written as 0.
+     *
+     * Unlike the HMC5883L, CRA7 (temperature sensor), MR5 and MR2 (LP and SIM) are kept. MR7 (HS) is
+     * cleared, since it is also set internally after each single measurement; high speed mode must
+     * be enabled again after the configuration is written back.
+     *
+     * @param   buf     CRA, CRB and MR values.
+     */
+    void maskConfiguration(unsigned char buf[3]);
+
     /**
      * Set speed mode.
      *
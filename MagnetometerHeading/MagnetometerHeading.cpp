@@ -0,0 +1,125 @@
+#include "MagnetometerHeading.h"
+#include <Arduino.h>
+
+/**
+ * Quarter sine wave in Q15, 32 steps from 0 to 90 degrees.
+ */
+static const int16_t SINE_TABLE[33] PROGMEM = {
+    0, 1608, 3212, 4808, 6393, 7962, 9512, 11039, 12539, 14010, 15446,
+    16846, 18204, 19519, 20787, 22005, 23170, 24279, 25329, 26319, 27245, 28105,
+    28898, 29621, 30273, 30852, 31356, 31785, 32137, 32412, 32609, 32728, 32767
+};
+
+/**
+ * Sine of a first quadrant binary angle (0 to 16384), in Q15.
+ */
+static int16_t quarterSine(uint16_t angle) {
+    unsigned char i = angle >> 9;
+    if (i >= 32) {
+        return (int16_t) pgm_read_word(&SINE_TABLE[32]);
+    }
+    int16_t a = (int16_t) pgm_read_word(&SINE_TABLE[i]);
+    int16_t b = (int16_t) pgm_read_word(&SINE_TABLE[i + 1]);
+    return a + (int16_t) (((int32_t) (b - a) * (angle & 0x1ff)) >> 9);
+}
+
+static int16_t sine(uint16_t angle) {
+    uint16_t within = angle & 0x3fff;
+    switch (angle >> 14) {
+    case 0:
+        return quarterSine(within);
+    case 1:
+        return quarterSine(0x4000 - within);
+    case 2:
+        return -quarterSine(within);
+    default:
+        return -quarterSine(0x4000 - within);
+    }
+}
+
+/**
+ * Arctangent of a Q15 ratio from 0 to 1, as a binary angle (0 to 8192).
+ *
+ * atan(z) ~ z * (PI/4 + 0.273 * (1 - z)), max error 0.22 degree.
+ */
+static uint16_t octantArctangent(uint32_t z) {
+    uint32_t t = 8192 + ((2847UL * (32768 - z)) >> 15);
+    return (uint16_t) ((z * t) >> 15);
+}
+
+MagnetometerHeading::MagnetometerHeading()
+        : declination(0) {
+}
+
+void MagnetometerHeading::setDeclination(double degrees) {
+    declination = (int16_t) fromDegrees(degrees);
+}
+
+int16_t MagnetometerHeading::getDeclination() {
+    return declination;
+}
+
+uint16_t MagnetometerHeading::toTrue(uint16_t magnetic) {
+    return magnetic + (uint16_t) declination;
+}
+
+uint16_t MagnetometerHeading::computeTrueHeading(int16_t x, int16_t y) {
+    return toTrue(computeBinaryAngle(x, y));
+}
+
+uint16_t MagnetometerHeading::computeBinaryAngle(int32_t x, int32_t y) {
+    uint32_t ax = x < 0 ? -x : x;
+    uint32_t ay = y < 0 ? -y : y;
+    uint16_t angle;
+    if (ax == 0 && ay == 0) {
+        return 0;
+    }
+    while (ax > 0xffff || ay > 0xffff) {
+        ax >>= 1;
+        ay >>= 1;
+    }
+    if (ax >= ay) {
+        angle = octantArctangent((ay << 15) / ax);
+    } else {
+        angle = 0x4000 - octantArctangent((ax << 15) / ay);
+    }
+    if (x < 0) {
+        angle = 0x8000 - angle;
+    }
+    if (y < 0) {
+        angle = -angle;
+    }
+
+    // Same orientation as computeVectorAngle(): -atan2(y, x).
+    return -angle;
+}
+
+void MagnetometerHeading::computeVector(uint16_t angle, int16_t &x, int16_t &y) {
+    x = sine(angle + 0x4000);
+    y = -sine(angle);
+}
+
+uint16_t MagnetometerHeading::fromDegrees(double degrees) {
+    double turns = fmod(degrees, 360.0);
+
+    // NAN and infinite degrees give NAN turns.
+    if (isnan(turns)) {
+        return 0;
+    }
+    if (turns < 0) {
+        turns += 360.0;
+    }
+    return (uint16_t) (long) (turns * (65536.0 / 360.0) + 0.5);
+}
+
+double MagnetometerHeading::toDegrees(uint16_t angle) {
+    return angle * (360.0 / 65536.0);
+}
+
+uint16_t MagnetometerHeading::toCentidegrees(uint16_t angle) {
+    return (uint16_t) ((angle * 36000UL + 0x8000) >> 16);
+}
+
+double MagnetometerHeading::toRadians(uint16_t angle) {
+    return angle * (2.0 * M_PI / 65536.0);
+}
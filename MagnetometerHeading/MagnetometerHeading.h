@@ -0,0 +1,124 @@
+/**
+ * Arduino - MagnetometerHeading
+ *
+ * Heading output stage: declination, units and integer angle arithmetic.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_HEADING_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_HEADING_H__ 1
+
+#include <inttypes.h>
+
+/**
+ * Headings are handled as 16 bits binary angles (65536 == 360 degrees, about
+ * 0.0055 degree per unit), so adding a declination or subtracting two headings
+ * wraps around by itself, without any < 0 or >= 360 test.
+ *
+ * The vector to angle conversion follows Magnetometer::computeVectorAngle() but
+ * uses an integer arctangent approximation (error below 0.25 degree, well under
+ * the sensor accuracy), so no floating point trigonometry is done per sample.
+ *
+ * Magnetic declination is the angle between magnetic north and true north,
+ * positive when magnetic north is east of true north:
+ *
+ * <pre>
+ * true = magnetic + declination
+ * </pre>
+ */
+class MagnetometerHeading {
+
+    /**
+     * Declination, binary angle.
+     */
+    int16_t declination;
+
+public:
+
+    /**
+     * Public constructor.
+     */
+    MagnetometerHeading();
+
+    /**
+     * Sets the magnetic declination.
+     *
+     * @param degrees       Declination in degrees, east positive.
+     */
+    void setDeclination(double degrees);
+
+    /**
+     * Gets the magnetic declination as a binary angle.
+     */
+    int16_t getDeclination();
+
+    /**
+     * Converts a magnetic heading into a true one.
+     *
+     * @param magnetic      Magnetic heading, binary angle.
+     * @return              True heading, binary angle.
+     */
+    uint16_t toTrue(uint16_t magnetic);
+
+    /**
+     * Computes the true heading of a raw vector.
+     *
+     * @param x             X read.
+     * @param y             Y read.
+     * @return              True heading, binary angle.
+     */
+    uint16_t computeTrueHeading(int16_t x, int16_t y);
+
+    /**
+     * Computes the magnetic heading of a vector, as computeVectorAngle() does, using integers only.
+     *
+     * @param x             X read.
+     * @param y             Y read.
+     * @return              Magnetic heading, binary angle.
+     */
+    static uint16_t computeBinaryAngle(int32_t x, int32_t y);
+
+    /**
+     * Computes the unit vector pointing to a heading, using a sine table.
+     *
+     * @param angle         Heading, binary angle.
+     * @param x             Where X in Q15 will be placed.
+     * @param y             Where Y in Q15 will be placed.
+     */
+    static void computeVector(uint16_t angle, int16_t &x, int16_t &y);
+
+    /**
+     * Converts degrees into a binary angle.
+     *
+     * @param degrees       Degrees, any range.
+     * @return              Binary angle, 0 for NAN or infinite degrees.
+     */
+    static uint16_t fromDegrees(double degrees);
+
+    /**
+     * Converts a binary angle into degrees.
+     *
+     * @param angle         Binary angle.
+     * @return              Degrees, from 0 up to (not including) 360.
+     */
+    static double toDegrees(uint16_t angle);
+
+    /**
+     * Converts a binary angle into centidegrees.
+     *
+     * @param angle         Binary angle.
+     * @return              Centidegrees, from 0 to 35999.
+     */
+    static uint16_t toCentidegrees(uint16_t angle);
+
+    /**
+     * Converts a binary angle into radians.
+     *
+     * @param angle         Binary angle.
+     * @return              Radians, from 0 up to (not including) 2 * PI.
+     */
+    static double toRadians(uint16_t angle);
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_HEADING_H__
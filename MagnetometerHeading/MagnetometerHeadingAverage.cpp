@@ -0,0 +1,35 @@
+#include "MagnetometerHeadingAverage.h"
+
+MagnetometerHeadingAverage::MagnetometerHeadingAverage() {
+    reset();
+}
+
+void MagnetometerHeadingAverage::reset() {
+    sumX = 0;
+    sumY = 0;
+    count = 0;
+}
+
+void MagnetometerHeadingAverage::add(int16_t x, int16_t y) {
+    sumX += x;
+    sumY += y;
+    count++;
+}
+
+void MagnetometerHeadingAverage::addAngle(uint16_t angle) {
+    int16_t x, y;
+    MagnetometerHeading::computeVector(angle, x, y);
+
+    // Q14 keeps the sums within 32 bits for up to 65535 samples.
+    sumX += x >> 1;
+    sumY += y >> 1;
+    count++;
+}
+
+uint16_t MagnetometerHeadingAverage::getCount() {
+    return count;
+}
+
+uint16_t MagnetometerHeadingAverage::getAverage() {
+    return MagnetometerHeading::computeBinaryAngle(sumX, sumY);
+}
@@ -0,0 +1,69 @@
+/**
+ * Arduino - MagnetometerHeadingAverage
+ *
+ * Wraparound safe circular average of headings.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_HEADING_AVERAGE_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_HEADING_AVERAGE_H__ 1
+
+#include <MagnetometerHeading.h>
+
+/**
+ * Averaging headings as plain numbers fails around north: 359 and 1 degrees
+ * average to 180. Instead, the vectors pointing to each heading are summed and
+ * the angle of the sum is taken once, when the average is requested.
+ *
+ * Raw magnetometer vectors can be added directly (weighted by their magnitude,
+ * which is nearly constant), or headings can be added as binary angles, turned
+ * into unit vectors by a sine table. Both must not be mixed in the same average.
+ */
+class MagnetometerHeadingAverage {
+
+    int32_t sumX;
+    int32_t sumY;
+    uint16_t count;
+
+public:
+
+    /**
+     * Public constructor.
+     */
+    MagnetometerHeadingAverage();
+
+    /**
+     * Clears the average.
+     */
+    void reset();
+
+    /**
+     * Adds a raw vector.
+     *
+     * @param x         X read.
+     * @param y         Y read.
+     */
+    void add(int16_t x, int16_t y);
+
+    /**
+     * Adds a heading.
+     *
+     * @param angle     Heading, binary angle.
+     */
+    void addAngle(uint16_t angle);
+
+    /**
+     * Gets how many samples were added.
+     */
+    uint16_t getCount();
+
+    /**
+     * Gets the average heading.
+     *
+     * @return          Average heading, binary angle.
+     */
+    uint16_t getAverage();
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_HEADING_AVERAGE_H__
@@ -0,0 +1,68 @@
+#include "MagnetometerLIS3MDL.h"
+
+MagnetometerLIS3MDL::MagnetometerLIS3MDL()
+        : RegisterBasedWiredDevice(MAGNETOMETER_LIS3MDL_DEVICE_ADDRESS) {
+}
+
+MagnetometerLIS3MDL::MagnetometerLIS3MDL(unsigned char address)
+        : RegisterBasedWiredDevice(address) {
+}
+
+MagnetometerLIS3MDL::~MagnetometerLIS3MDL() {
+}
+
+double MagnetometerLIS3MDL::getHeading() {
+    int16_t x = 0, y = 0, z = 0;
+    if (!readAxes(x, y, z)) {
+        return NAN;
+    }
+    return computeVectorAngle(x, y);
+}
+
+void MagnetometerLIS3MDL::reset() {
+    writeRegister(CTRL_REG2, MAGNETOMETER_LIS3MDL_CTRL2_SOFT_RST);
+}
+
+void MagnetometerLIS3MDL::setOperatingMode(unsigned char operatingMode) {
+    configureRegisterBits(CTRL_REG3, MAGNETOMETER_LIS3MDL_CTRL3_MD_MASK, operatingMode);
+}
+
+void MagnetometerLIS3MDL::setDataOutputRate(unsigned char dataOutputRate) {
+    configureRegisterBits(CTRL_REG1, MAGNETOMETER_LIS3MDL_CTRL1_DO_MASK, dataOutputRate << 2);
+}
+
+void MagnetometerLIS3MDL::setPerformanceMode(unsigned char performanceMode) {
+    configureRegisterBits(CTRL_REG1, MAGNETOMETER_LIS3MDL_CTRL1_OM_MASK, performanceMode << 5);
+    configureRegisterBits(CTRL_REG4, MAGNETOMETER_LIS3MDL_CTRL4_OMZ_MASK, performanceMode << 2);
+}
+
+void MagnetometerLIS3MDL::setFullScale(unsigned char fullScale) {
+    configureRegisterBits(CTRL_REG2, MAGNETOMETER_LIS3MDL_CTRL2_FS_MASK, fullScale << 5);
+}
+
+void MagnetometerLIS3MDL::setBlockDataUpdate(bool enable) {
+    configureRegisterBits(CTRL_REG5, MAGNETOMETER_LIS3MDL_CTRL5_BDU_MASK, enable ? MAGNETOMETER_LIS3MDL_CTRL5_BDU_MASK : 0);
+}
+
+MagnetometerLIS3MDL::SRbits MagnetometerLIS3MDL::getStatusRegister() {
+    MagnetometerLIS3MDL::SRbits sr = {0};
+    sr.value = readRegister(STATUS_REG);
+    return sr;
+}
+
+unsigned char MagnetometerLIS3MDL::getWhoAmI() {
+    return readRegister(WHO_AM_I);
+}
+
+int MagnetometerLIS3MDL::readSample(unsigned char buf[6]) {
+    return readRegisterBlock(OUT_X_L | MAGNETOMETER_LIS3MDL_AUTO_INCREMENT, buf, 0x06);
+}
+
+bool MagnetometerLIS3MDL::readAxes(int16_t &x, int16_t &y, int16_t &z) {
+    unsigned char buf[6] = {0};
+    int n = readSample(buf);
+    x = decodeLittleEndian(&buf[0]);
+    y = decodeLittleEndian(&buf[2]);
+    z = decodeLittleEndian(&buf[4]);
+    return n == 6;
+}
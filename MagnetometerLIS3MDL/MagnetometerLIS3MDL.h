@@ -0,0 +1,231 @@
+/**
+ * Arduino - MagnetometerLIS3MDL driver
+ *
+ * Concrete implementation of LIS3MDL magnetometer.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_LIS3MDL_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_LIS3MDL_H__ 1
+
+#include <Magnetometer.h>
+#include <RegisterBasedWiredDevice.h>
+
+#define MAGNETOMETER_LIS3MDL_DEVICE_ADDRESS     0x1e
+#define MAGNETOMETER_LIS3MDL_ALTERNATE_ADDRESS  0x1c
+#define MAGNETOMETER_LIS3MDL_WHO_AM_I           0x3d
+
+#define MAGNETOMETER_LIS3MDL_AUTO_INCREMENT     0x80
+
+#define MAGNETOMETER_LIS3MDL_CTRL1_OM_MASK      0x60
+#define MAGNETOMETER_LIS3MDL_CTRL1_DO_MASK      0x1c
+#define MAGNETOMETER_LIS3MDL_CTRL2_FS_MASK      0x60
+#define MAGNETOMETER_LIS3MDL_CTRL2_SOFT_RST     0x04
+#define MAGNETOMETER_LIS3MDL_CTRL3_MD_MASK      0x03
+#define MAGNETOMETER_LIS3MDL_CTRL4_OMZ_MASK     0x0c
+#define MAGNETOMETER_LIS3MDL_CTRL5_BDU_MASK     0x40
+
+/**
+ * The ST LIS3MDL is an ultra-low-power, high-performance 3-axis magnetic sensor
+ * with a 16 bits output, selectable full scale (±4/±8/±12/±16 gauss) and output
+ * data rates from 0.625 Hz to 80 Hz (up to 1 kHz in fast mode).
+ *
+ * It shares the 0x1e address with the HMC5883L when SA1 is high (0x1c otherwise),
+ * so the WHO_AM_I register must be used to tell them apart.
+ */
+class MagnetometerLIS3MDL: public Magnetometer, public RegisterBasedWiredDevice {
+
+public:
+
+    /**
+     * Status Register
+     *
+     * <pre>
+     * STATUS3 (ZYXDA):
+     *      X, Y and Z axis new data available.
+     *
+     * STATUS7 (ZYXOR):
+     *      X, Y and Z axis data overrun.
+     * </pre>
+     */
+    union SRbits {
+
+        struct {
+            unsigned char XDA :1;
+            unsigned char YDA :1;
+            unsigned char ZDA :1;
+            unsigned char ZYXDA :1;
+            unsigned char XOR :1;
+            unsigned char YOR :1;
+            unsigned char ZOR :1;
+            unsigned char ZYXOR :1;
+        };
+        unsigned char value;
+    };
+
+    /*
+     * 0f Who Am I Register Read
+     * 20 Control Register 1 Read/Write
+     * 21 Control Register 2 Read/Write
+     * 22 Control Register 3 Read/Write
+     * 23 Control Register 4 Read/Write
+     * 24 Control Register 5 Read/Write
+     * 27 Status Register Read
+     * 28 to 2d Data Output X, Y and Z, LSB first, Read
+     * 2e to 2f Temperature Output, LSB first, Read
+     */
+    enum Register {
+        WHO_AM_I = 0x0f,
+        CTRL_REG1 = 0x20,
+        CTRL_REG2 = 0x21,
+        CTRL_REG3 = 0x22,
+        CTRL_REG4 = 0x23,
+        CTRL_REG5 = 0x24,
+        STATUS_REG = 0x27,
+        OUT_X_L = 0x28,
+        OUT_X_H = 0x29,
+        OUT_Y_L = 0x2a,
+        OUT_Y_H = 0x2b,
+        OUT_Z_L = 0x2c,
+        OUT_Z_H = 0x2d,
+        TEMP_OUT_L = 0x2e,
+        TEMP_OUT_H = 0x2f
+    };
+
+    /**
+     * Operating mode (CTRL_REG3 MD).
+     */
+    enum OperatingMode {
+        CONTINUOUS_MEASUREMENT_MODE = 0x00,
+        SINGLE_MEASUREMENT_MODE = 0x01,
+        POWER_DOWN_MODE = 0x02
+    };
+
+    /**
+     * Output data rate (CTRL_REG1 DO).
+     */
+    enum DataOutputRate {
+        DAR_0_625 = 0x00,
+        DAR_1_25 = 0x01,
+        DAR_2_5 = 0x02,
+        DAR_5 = 0x03,
+        DAR_10 = 0x04,
+        DAR_20 = 0x05,
+        DAR_40 = 0x06,
+        DAR_80 = 0x07
+    };
+
+    /**
+     * Performance mode, for X and Y (CTRL_REG1 OM) and Z (CTRL_REG4 OMZ) axes.
+     */
+    enum PerformanceMode {
+        LOW_POWER_MODE = 0x00,
+        MEDIUM_PERFORMANCE_MODE = 0x01,
+        HIGH_PERFORMANCE_MODE = 0x02,
+        ULTRA_HIGH_PERFORMANCE_MODE = 0x03
+    };
+
+    /**
+     * Full scale (CTRL_REG2 FS).
+     */
+    enum FullScale {
+        RANGE_4_GA = 0x00,
+        RANGE_8_GA = 0x01,
+        RANGE_12_GA = 0x02,
+        RANGE_16_GA = 0x03
+    };
+
+    /**
+     * Public constructor, SA1 high.
+     */
+    MagnetometerLIS3MDL();
+
+    /**
+     * Public constructor.
+     *
+     * @param address           MAGNETOMETER_LIS3MDL_DEVICE_ADDRESS or MAGNETOMETER_LIS3MDL_ALTERNATE_ADDRESS.
+     */
+    MagnetometerLIS3MDL(unsigned char address);
+
+    /**
+     * Virtual destructor
+     */
+    virtual ~MagnetometerLIS3MDL();
+
+    /**
+     * Soft resets the configuration and user registers.
+     */
+    void reset();
+
+    /**
+     * Configure operating mode.
+     *
+     * @param operatingMode     OperatingMode option.
+     */
+    void setOperatingMode(unsigned char operatingMode);
+
+    /**
+     * Sets data output rate.
+     *
+     * @param dataOutputRate    DataOutputRate option.
+     */
+    void setDataOutputRate(unsigned char dataOutputRate);
+
+    /**
+     * Sets the performance mode of all axes.
+     *
+     * @param performanceMode   PerformanceMode option.
+     */
+    void setPerformanceMode(unsigned char performanceMode);
+
+    /**
+     * Sets full scale.
+     *
+     * @param fullScale         FullScale option.
+     */
+    void setFullScale(unsigned char fullScale);
+
+    /**
+     * Sets block data update: output registers are not updated until both MSB and LSB were read.
+     *
+     * @param enable            True to enable.
+     */
+    void setBlockDataUpdate(bool enable);
+
+    /**
+     * Gets the status register.
+     */
+    SRbits getStatusRegister();
+
+    /**
+     * Gets the identification, 0x3d for this device.
+     */
+    unsigned char getWhoAmI();
+
+    /**
+     * Reads the sample.
+     *
+     * Read all 6 bytes, X, Y and Z, LSB first.
+     *
+     * @param   buf     The where sample will be placed.
+     * @return          The number of bytes read.
+     */
+    int readSample(unsigned char buf[6]);
+
+    /**
+     * Reads the sample and decodes it into the three axes.
+     *
+     * @return          True if all 6 bytes were read.
+     */
+    bool readAxes(int16_t &x, int16_t &y, int16_t &z);
+
+    /**
+     * Gets the heading in degree.
+     *
+     * @return          The heading, or NAN if the sample could not be read.
+     */
+    double getHeading();
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_LIS3MDL_H__
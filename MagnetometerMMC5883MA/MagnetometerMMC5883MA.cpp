@@ -0,0 +1,63 @@
+#include "MagnetometerMMC5883MA.h"
+
+MagnetometerMMC5883MA::MagnetometerMMC5883MA()
+        : RegisterBasedWiredDevice(MAGNETOMETER_MMC5883MA_DEVICE_ADDRESS) {
+}
+
+MagnetometerMMC5883MA::~MagnetometerMMC5883MA() {
+}
+
+double MagnetometerMMC5883MA::getHeading() {
+    int16_t x = 0, y = 0, z = 0;
+    if (!readAxes(x, y, z)) {
+        return NAN;
+    }
+    return computeVectorAngle(x, y);
+}
+
+void MagnetometerMMC5883MA::reset() {
+    writeRegister(CONTROL1, MAGNETOMETER_MMC5883MA_CTRL1_SW_RST);
+}
+
+void MagnetometerMMC5883MA::setBandwidth(unsigned char bandwidth) {
+    writeRegister(CONTROL1, bandwidth & MAGNETOMETER_MMC5883MA_CTRL1_BW_MASK);
+}
+
+void MagnetometerMMC5883MA::setContinuousMeasurementFrequency(unsigned char frequency) {
+    writeRegister(CONTROL2, frequency & MAGNETOMETER_MMC5883MA_CTRL2_CM_MASK);
+}
+
+void MagnetometerMMC5883MA::triggerMeasurement() {
+    writeRegister(CONTROL0, MAGNETOMETER_MMC5883MA_CTRL0_TM_M);
+}
+
+void MagnetometerMMC5883MA::performSet() {
+    writeRegister(CONTROL0, MAGNETOMETER_MMC5883MA_CTRL0_SET);
+}
+
+void MagnetometerMMC5883MA::performReset() {
+    writeRegister(CONTROL0, MAGNETOMETER_MMC5883MA_CTRL0_RESET);
+}
+
+MagnetometerMMC5883MA::SRbits MagnetometerMMC5883MA::getStatusRegister() {
+    MagnetometerMMC5883MA::SRbits sr = {0};
+    sr.value = readRegister(STATUS);
+    return sr;
+}
+
+unsigned char MagnetometerMMC5883MA::getProductId() {
+    return readRegister(PRODUCT_ID);
+}
+
+int MagnetometerMMC5883MA::readSample(unsigned char buf[6]) {
+    return readRegisterBlock(XOUT_L, buf, 0x06);
+}
+
+bool MagnetometerMMC5883MA::readAxes(int16_t &x, int16_t &y, int16_t &z) {
+    unsigned char buf[6] = {0x00, 0x80, 0x00, 0x80, 0x00, 0x80};
+    int n = readSample(buf);
+    x = (int16_t) ((uint16_t) decodeLittleEndian(&buf[0]) - MAGNETOMETER_MMC5883MA_NULL_FIELD);
+    y = (int16_t) ((uint16_t) decodeLittleEndian(&buf[2]) - MAGNETOMETER_MMC5883MA_NULL_FIELD);
+    z = (int16_t) ((uint16_t) decodeLittleEndian(&buf[4]) - MAGNETOMETER_MMC5883MA_NULL_FIELD);
+    return n == 6;
+}
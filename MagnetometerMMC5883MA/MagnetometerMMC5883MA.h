@@ -0,0 +1,197 @@
+/**
+ * Arduino - MagnetometerMMC5883MA driver
+ *
+ * Concrete implementation of MMC5883MA magnetometer.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_MMC5883MA_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_MMC5883MA_H__ 1
+
+#include <Magnetometer.h>
+#include <RegisterBasedWiredDevice.h>
+
+#define MAGNETOMETER_MMC5883MA_DEVICE_ADDRESS   0x30
+#define MAGNETOMETER_MMC5883MA_PRODUCT_ID       0x0c
+#define MAGNETOMETER_MMC5883MA_NULL_FIELD       32768
+
+#define MAGNETOMETER_MMC5883MA_CTRL0_TM_M       0x01
+#define MAGNETOMETER_MMC5883MA_CTRL0_TM_T       0x02
+#define MAGNETOMETER_MMC5883MA_CTRL0_SET        0x08
+#define MAGNETOMETER_MMC5883MA_CTRL0_RESET      0x10
+#define MAGNETOMETER_MMC5883MA_CTRL1_BW_MASK    0x03
+#define MAGNETOMETER_MMC5883MA_CTRL1_SW_RST     0x80
+#define MAGNETOMETER_MMC5883MA_CTRL2_CM_MASK    0x0f
+
+/**
+ * The MEMSIC MMC5883MA is a 3-axis AMR magnetic sensor with a 16 bits output
+ * (4096 LSB/G, ±8G), on chip SET/RESET degaussing and both triggered and
+ * continuous measurements.
+ *
+ * Its outputs are unsigned, LSB first, with the null field at 32768; readAxes()
+ * returns them centered at zero like the other drivers.
+ */
+class MagnetometerMMC5883MA: public Magnetometer, public RegisterBasedWiredDevice {
+
+public:
+
+    /**
+     * Status Register
+     *
+     * <pre>
+     * STATUS0 (MEAS_M_DONE):
+     *      Magnetic measurement done.
+     *
+     * STATUS1 (MEAS_T_DONE):
+     *      Temperature measurement done.
+     *
+     * STATUS2 (MOTION_DETECTED):
+     *      Motion detected.
+     * </pre>
+     */
+    union SRbits {
+
+        struct {
+            unsigned char MEAS_M_DONE :1;
+            unsigned char MEAS_T_DONE :1;
+            unsigned char MOTION_DETECTED :1;
+            unsigned char :5;
+        };
+        unsigned char value;
+    };
+
+    /*
+     * 00 to 05 Data Output X, Y and Z, LSB first, Read
+     * 06 Temperature Output Read
+     * 07 Status Register Read/Write
+     * 08 Internal Control 0 Write
+     * 09 Internal Control 1 Write
+     * 0a Internal Control 2 Write
+     * 0b to 0d Motion Detection Thresholds Write
+     * 2f Product ID Read
+     */
+    enum Register {
+        XOUT_L = 0x00,
+        XOUT_H = 0x01,
+        YOUT_L = 0x02,
+        YOUT_H = 0x03,
+        ZOUT_L = 0x04,
+        ZOUT_H = 0x05,
+        TOUT = 0x06,
+        STATUS = 0x07,
+        CONTROL0 = 0x08,
+        CONTROL1 = 0x09,
+        CONTROL2 = 0x0a,
+        X_THRESHOLD = 0x0b,
+        Y_THRESHOLD = 0x0c,
+        Z_THRESHOLD = 0x0d,
+        PRODUCT_ID = 0x2f
+    };
+
+    /**
+     * Measurement bandwidth (measurement time).
+     */
+    enum Bandwidth {
+        BW_100_HZ = 0x00,
+        BW_200_HZ = 0x01,
+        BW_400_HZ = 0x02,
+        BW_600_HZ = 0x03
+    };
+
+    /**
+     * Continuous measurement frequency.
+     */
+    enum ContinuousMeasurementFrequency {
+        CM_OFF = 0x00,
+        CM_14_HZ = 0x01,
+        CM_5_HZ = 0x02,
+        CM_2_2_HZ = 0x03,
+        CM_1_HZ = 0x04,
+        CM_0_5_HZ = 0x05
+    };
+
+    /**
+     * Public constructor.
+     */
+    MagnetometerMMC5883MA();
+
+    /**
+     * Virtual destructor
+     */
+    virtual ~MagnetometerMMC5883MA();
+
+    /**
+     * Software reset, all registers back to their defaults.
+     */
+    void reset();
+
+    /**
+     * Sets measurement bandwidth.
+     *
+     * Control registers are write only, so the other CONTROL1 bits are cleared.
+     *
+     * @param bandwidth         Bandwidth option.
+     */
+    void setBandwidth(unsigned char bandwidth);
+
+    /**
+     * Sets continuous measurement frequency.
+     *
+     * Control registers are write only, so the other CONTROL2 bits are cleared.
+     *
+     * @param frequency         ContinuousMeasurementFrequency option.
+     */
+    void setContinuousMeasurementFrequency(unsigned char frequency);
+
+    /**
+     * Triggers a single magnetic measurement.
+     */
+    void triggerMeasurement();
+
+    /**
+     * Sends a SET pulse, restoring the sensor magnetization after a strong field.
+     */
+    void performSet();
+
+    /**
+     * Sends a RESET pulse, the reverse of SET.
+     */
+    void performReset();
+
+    /**
+     * Gets the status register.
+     */
+    SRbits getStatusRegister();
+
+    /**
+     * Gets the product id, 0x0c for this device.
+     */
+    unsigned char getProductId();
+
+    /**
+     * Reads the sample.
+     *
+     * Read all 6 bytes, X, Y and Z, LSB first.
+     *
+     * @param   buf     The where sample will be placed.
+     * @return          The number of bytes read.
+     */
+    int readSample(unsigned char buf[6]);
+
+    /**
+     * Reads the sample and decodes it into the three axes.
+     *
+     * @return          True if all 6 bytes were read.
+     */
+    bool readAxes(int16_t &x, int16_t &y, int16_t &z);
+
+    /**
+     * Gets the heading in degree.
+     *
+     * @return          The heading, or NAN if the sample could not be read.
+     */
+    double getHeading();
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_MMC5883MA_H__
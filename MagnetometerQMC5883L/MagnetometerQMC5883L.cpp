@@ -0,0 +1,60 @@
+#include "MagnetometerQMC5883L.h"
+
+MagnetometerQMC5883L::MagnetometerQMC5883L()
+        : RegisterBasedWiredDevice(MAGNETOMETER_QMC5883L_DEVICE_ADDRESS) {
+}
+
+MagnetometerQMC5883L::~MagnetometerQMC5883L() {
+}
+
+double MagnetometerQMC5883L::getHeading() {
+    int16_t x = 0, y = 0, z = 0;
+    if (!readAxes(x, y, z)) {
+        return NAN;
+    }
+    return computeVectorAngle(x, y);
+}
+
+void MagnetometerQMC5883L::reset() {
+    writeRegister(CR2, MAGNETOMETER_QMC5883L_CR2_SOFT_RST);
+    writeRegister(SRPR, MAGNETOMETER_QMC5883L_SET_RESET_PERIOD);
+}
+
+void MagnetometerQMC5883L::setOperatingMode(unsigned char operatingMode) {
+    configureRegisterBits(CR1, MAGNETOMETER_QMC5883L_CR1_MODE_MASK, operatingMode);
+}
+
+void MagnetometerQMC5883L::setDataOutputRate(unsigned char dataOutputRate) {
+    configureRegisterBits(CR1, MAGNETOMETER_QMC5883L_CR1_ODR_MASK, dataOutputRate << 2);
+}
+
+void MagnetometerQMC5883L::setFullScale(unsigned char fullScale) {
+    configureRegisterBits(CR1, MAGNETOMETER_QMC5883L_CR1_RNG_MASK, fullScale << 4);
+}
+
+void MagnetometerQMC5883L::setOverSampleRatio(unsigned char overSampleRatio) {
+    configureRegisterBits(CR1, MAGNETOMETER_QMC5883L_CR1_OSR_MASK, overSampleRatio << 6);
+}
+
+MagnetometerQMC5883L::SRbits MagnetometerQMC5883L::getStatusRegister() {
+    MagnetometerQMC5883L::SRbits sr = {0};
+    sr.value = readRegister(SR);
+    return sr;
+}
+
+unsigned char MagnetometerQMC5883L::getChipId() {
+    return readRegister(CHIP_ID);
+}
+
+int MagnetometerQMC5883L::readSample(unsigned char buf[6]) {
+    return readRegisterBlock(DXL, buf, 0x06);
+}
+
+bool MagnetometerQMC5883L::readAxes(int16_t &x, int16_t &y, int16_t &z) {
+    unsigned char buf[6] = {0};
+    int n = readSample(buf);
+    x = decodeLittleEndian(&buf[0]);
+    y = decodeLittleEndian(&buf[2]);
+    z = decodeLittleEndian(&buf[4]);
+    return n == 6;
+}
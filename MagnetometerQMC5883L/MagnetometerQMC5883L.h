@@ -0,0 +1,239 @@
+/**
+ * Arduino - MagnetometerQMC5883L driver
+ *
+ * Concrete implementation of QMC5883L magnetometer.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_QMC5883L_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_QMC5883L_H__ 1
+
+#include <Magnetometer.h>
+#include <RegisterBasedWiredDevice.h>
+
+#define MAGNETOMETER_QMC5883L_DEVICE_ADDRESS    0x0d
+#define MAGNETOMETER_QMC5883L_CHIP_ID           0xff
+
+#define MAGNETOMETER_QMC5883L_CR1_MODE_MASK     0x03
+#define MAGNETOMETER_QMC5883L_CR1_ODR_MASK      0x0c
+#define MAGNETOMETER_QMC5883L_CR1_RNG_MASK      0x30
+#define MAGNETOMETER_QMC5883L_CR1_OSR_MASK      0xc0
+
+#define MAGNETOMETER_QMC5883L_CR2_SOFT_RST      0x80
+#define MAGNETOMETER_QMC5883L_SET_RESET_PERIOD  0x01
+
+/**
+ * The QST QMC5883L is a 3-axis magnetic sensor with a 16 bits ADC, found on
+ * many boards sold as HMC5883L modules. It answers at a different I2C address,
+ * has a different register map and outputs data LSB first, so the HMC5883L
+ * driver cannot read it.
+ */
+class MagnetometerQMC5883L: public Magnetometer, public RegisterBasedWiredDevice {
+
+public:
+
+    /**
+     * Control Register 1
+     *
+     * <pre>
+     * CR1 1 to 0 (MODE):
+     *      00 -> Standby (Default).
+     *      01 -> Continuous.
+     *
+     * CR1 3 to 2 (ODR):
+     *      Output data rate.
+     *      00 -> 10Hz; 01 -> 50Hz; 10 -> 100Hz; 11 -> 200Hz.
+     *
+     * CR1 5 to 4 (RNG):
+     *      Full scale.
+     *      00 -> ±2G (12000 LSB/G); 01 -> ±8G (3000 LSB/G).
+     *
+     * CR1 7 to 6 (OSR):
+     *      Over sample ratio. Larger values mean smaller bandwidth, lower noise and more power.
+     *      00 -> 512; 01 -> 256; 10 -> 128; 11 -> 64.
+     * </pre>
+     */
+    union CR1bits {
+
+        struct {
+            unsigned char MODE :2;
+            unsigned char ODR :2;
+            unsigned char RNG :2;
+            unsigned char OSR :2;
+        };
+        unsigned char value;
+    };
+
+    /**
+     * Status Register
+     *
+     * <pre>
+     * SR0 (DRDY):
+     *      Set when all three axes data are ready, cleared when any data register is read.
+     *
+     * SR1 (OVL):
+     *      Set when any axis output exceeds the full scale.
+     *
+     * SR2 (DOR):
+     *      Data skipped. Set when data were not all read in the previous measurement.
+     * </pre>
+     */
+    union SRbits {
+
+        struct {
+            unsigned char DRDY :1;
+            unsigned char OVL :1;
+            unsigned char DOR :1;
+            unsigned char :5;
+        };
+        unsigned char value;
+    };
+
+    /*
+     * 00 Data Output X LSB Register Read
+     * 01 Data Output X MSB Register Read
+     * 02 Data Output Y LSB Register Read
+     * 03 Data Output Y MSB Register Read
+     * 04 Data Output Z LSB Register Read
+     * 05 Data Output Z MSB Register Read
+     * 06 Status Register Read
+     * 07 Temperature LSB Register Read
+     * 08 Temperature MSB Register Read
+     * 09 Control Register 1 Read/Write
+     * 0a Control Register 2 Read/Write
+     * 0b SET/RESET Period Register Read/Write
+     * 0d Chip ID Register Read
+     */
+    enum Register {
+        DXL = 0x00,
+        DXH = 0x01,
+        DYL = 0x02,
+        DYH = 0x03,
+        DZL = 0x04,
+        DZH = 0x05,
+        SR = 0x06,
+        TOUTL = 0x07,
+        TOUTH = 0x08,
+        CR1 = 0x09,
+        CR2 = 0x0a,
+        SRPR = 0x0b,
+        CHIP_ID = 0x0d
+    };
+
+    /**
+     * Operating mode.
+     */
+    enum OperatingMode {
+        STANDBY_MODE = 0x00,
+        CONTINUOUS_MEASUREMENT_MODE = 0x01
+    };
+
+    /**
+     * Output data rate.
+     */
+    enum DataOutputRate {
+        DAR_10 = 0x00,
+        DAR_50 = 0x01,
+        DAR_100 = 0x02,
+        DAR_200 = 0x03
+    };
+
+    /**
+     * Full scale.
+     */
+    enum FullScale {
+        RANGE_2_GA = 0x00,
+        RANGE_8_GA = 0x01
+    };
+
+    /**
+     * Over sample ratio.
+     */
+    enum OverSampleRatio {
+        OSR_512 = 0x00,
+        OSR_256 = 0x01,
+        OSR_128 = 0x02,
+        OSR_64 = 0x03
+    };
+
+    /**
+     * Public constructor.
+     */
+    MagnetometerQMC5883L();
+
+    /**
+     * Virtual destructor
+     */
+    virtual ~MagnetometerQMC5883L();
+
+    /**
+     * Soft resets the device and programs the recommended SET/RESET period.
+     * Registers go back to their defaults (standby mode).
+     */
+    void reset();
+
+    /**
+     * Configure operating mode.
+     *
+     * @param operatingMode     OperatingMode option.
+     */
+    void setOperatingMode(unsigned char operatingMode);
+
+    /**
+     * Sets data output rate.
+     *
+     * @param dataOutputRate    DataOutputRate option.
+     */
+    void setDataOutputRate(unsigned char dataOutputRate);
+
+    /**
+     * Sets full scale.
+     *
+     * @param fullScale         FullScale option.
+     */
+    void setFullScale(unsigned char fullScale);
+
+    /**
+     * Sets over sample ratio.
+     *
+     * @param overSampleRatio   OverSampleRatio option.
+     */
+    void setOverSampleRatio(unsigned char overSampleRatio);
+
+    /**
+     * Gets the status register.
+     */
+    SRbits getStatusRegister();
+
+    /**
+     * Gets the chip id, 0xff for this device.
+     */
+    unsigned char getChipId();
+
+    /**
+     * Reads the sample.
+     *
+     * Read all 6 bytes, X, Y and Z, LSB first.
+     *
+     * @param   buf     The where sample will be placed.
+     * @return          The number of bytes read.
+     */
+    int readSample(unsigned char buf[6]);
+
+    /**
+     * Reads the sample and decodes it into the three axes.
+     *
+     * @return          True if all 6 bytes were read.
+     */
+    bool readAxes(int16_t &x, int16_t &y, int16_t &z);
+
+    /**
+     * Gets the heading in degree.
+     *
+     * @return          The heading, or NAN if the sample could not be read.
+     */
+    double getHeading();
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_QMC5883L_H__
@@ -0,0 +1,162 @@
+#include "MagnetometerRecovery.h"
+#include <Arduino.h>
+#include <Wire.h>
+
+MagnetometerRecovery::MagnetometerRecovery(MagnetometerHMC5883L *magnetometer)
+        : magnetometer(magnetometer), timeout(MAGNETOMETER_RECOVERY_DEFAULT_TIMEOUT), staleLimit(0), staleCount(0),
+          errors(0), recoveries(0), sdaPin(SDA), sclPin(SCL), retries(MAGNETOMETER_RECOVERY_DEFAULT_RETRIES),
+          lastError(NO_ERROR), configured(false), lastHeading(NAN) {
+    configuration[0] = configuration[1] = configuration[2] = 0;
+    last[0] = last[1] = last[2] = 0;
+}
+
+MagnetometerRecovery::MagnetometerRecovery(MagnetometerHMC5883L *magnetometer, unsigned char sdaPin, unsigned char sclPin)
+        : magnetometer(magnetometer), timeout(MAGNETOMETER_RECOVERY_DEFAULT_TIMEOUT), staleLimit(0), staleCount(0),
+          errors(0), recoveries(0), sdaPin(sdaPin), sclPin(sclPin), retries(MAGNETOMETER_RECOVERY_DEFAULT_RETRIES),
+          lastError(NO_ERROR), configured(false), lastHeading(NAN) {
+    configuration[0] = configuration[1] = configuration[2] = 0;
+    last[0] = last[1] = last[2] = 0;
+}
+
+MagnetometerRecovery::~MagnetometerRecovery() {
+}
+
+bool MagnetometerRecovery::begin(unsigned long timeout) {
+    this->timeout = timeout;
+#if defined(WIRE_HAS_TIMEOUT)
+    Wire.setWireTimeout(timeout, true);
+#endif
+    unsigned char read[3];
+    if (magnetometer->readConfiguration(read) != 3) {
+        return false;
+    }
+    magnetometer->maskConfiguration(read);
+
+    // Reading MR sets LOCK, rewriting it releases the data output registers.
+    magnetometer->writeConfiguration(read);
+    unsigned char operatingMode = read[2] & MAGNETOMETER_HMC5883L_MR_MASK;
+    if (operatingMode != MagnetometerHMC5883L::CONTINUOUS_MEASUREMENT_MODE
+            && operatingMode != MagnetometerHMC5883L::SINGLE_MEASUREMENT_MODE) {
+        return false;
+    }
+    setConfiguration(read[0], read[1], read[2]);
+    return true;
+}
+
+void MagnetometerRecovery::setConfiguration(unsigned char cra, unsigned char crb, unsigned char mr) {
+    configuration[0] = cra;
+    configuration[1] = crb;
+    configuration[2] = mr;
+    configured = true;
+}
+
+void MagnetometerRecovery::setMaxRetries(unsigned char retries) {
+    this->retries = retries;
+}
+
+void MagnetometerRecovery::setStaleLimit(uint16_t samples) {
+    staleLimit = samples;
+    staleCount = 0;
+}
+
+void MagnetometerRecovery::resetBus() {
+    Wire.end();
+    pinMode(sdaPin, INPUT_PULLUP);
+    pinMode(sclPin, INPUT_PULLUP);
+
+    // Open drain emulation: a line is driven low as output, released as input.
+    for (unsigned char i = 0; i < MAGNETOMETER_RECOVERY_CLOCK_PULSES && digitalRead(sdaPin) == LOW; i++) {
+        digitalWrite(sclPin, LOW);
+        pinMode(sclPin, OUTPUT);
+        delayMicroseconds(MAGNETOMETER_RECOVERY_HALF_PERIOD_MICROS);
+        pinMode(sclPin, INPUT_PULLUP);
+        delayMicroseconds(MAGNETOMETER_RECOVERY_HALF_PERIOD_MICROS);
+    }
+
+    // STOP: SDA rising while SCL is high.
+    digitalWrite(sdaPin, LOW);
+    pinMode(sdaPin, OUTPUT);
+    delayMicroseconds(MAGNETOMETER_RECOVERY_HALF_PERIOD_MICROS);
+    pinMode(sdaPin, INPUT_PULLUP);
+    delayMicroseconds(MAGNETOMETER_RECOVERY_HALF_PERIOD_MICROS);
+    Wire.begin();
+#if defined(WIRE_HAS_TIMEOUT)
+    Wire.setWireTimeout(timeout, true);
+#endif
+}
+
+void MagnetometerRecovery::recover(bool resetBus) {
+    if (resetBus) {
+        this->resetBus();
+    }
+    if (configured) {
+        magnetometer->writeConfiguration(configuration);
+    }
+    staleCount = 0;
+    recoveries++;
+}
+
+unsigned long MagnetometerRecovery::getMaxLatency() {
+
+    // Every attempt reads (2 transfers) and is followed by a configuration write (1 transfer):
+    // a retry, or the stale sample recovery after the last one. Bus resets start at the second retry.
+    unsigned long resets = retries > 1 ? retries - 1 : 0;
+    return 3 * (retries + 1UL) * timeout + resets * MAGNETOMETER_RECOVERY_RESET_MICROS;
+}
+
+uint16_t MagnetometerRecovery::getErrorCount() {
+    return errors;
+}
+
+uint16_t MagnetometerRecovery::getRecoveryCount() {
+    return recoveries;
+}
+
+bool MagnetometerRecovery::isHealthy() {
+    return lastError == NO_ERROR;
+}
+
+unsigned char MagnetometerRecovery::getLastError() {
+    return lastError;
+}
+
+bool MagnetometerRecovery::isStale(int16_t x, int16_t y, int16_t z) {
+    if (x != last[0] || y != last[1] || z != last[2]) {
+        last[0] = x;
+        last[1] = y;
+        last[2] = z;
+        staleCount = 0;
+        return false;
+    }
+    return staleLimit > 0 && ++staleCount >= staleLimit;
+}
+
+bool MagnetometerRecovery::readAxes(int16_t &x, int16_t &y, int16_t &z) {
+    for (unsigned char attempt = 0;; attempt++) {
+        if (magnetometer->readAxes(x, y, z)) {
+
+            // A fresh sample is only available after the next conversion, do not retry.
+            if (!isStale(x, y, z)) {
+                lastError = NO_ERROR;
+                lastHeading = computeVectorAngle(x, y);
+                return true;
+            }
+            lastError = STALE;
+            errors++;
+            recover(false);
+            return false;
+        }
+        errors++;
+        lastError = TRANSFER_ERROR;
+        if (attempt >= retries) {
+            return false;
+        }
+        recover(attempt > 0);
+    }
+}
+
+double MagnetometerRecovery::getHeading() {
+    int16_t x = 0, y = 0, z = 0;
+    readAxes(x, y, z);
+    return lastHeading;
+}
@@ -0,0 +1,225 @@
+/**
+ * Arduino - MagnetometerRecovery
+ *
+ * Bounded retries, bus reset and configuration restore around HMC5883L reads.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_RECOVERY_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_RECOVERY_H__ 1
+
+#include <Magnetometer.h>
+#include <MagnetometerHMC5883L.h>
+
+#define MAGNETOMETER_RECOVERY_DEFAULT_RETRIES       2
+#define MAGNETOMETER_RECOVERY_DEFAULT_TIMEOUT       2000
+#define MAGNETOMETER_RECOVERY_CLOCK_PULSES          9
+#define MAGNETOMETER_RECOVERY_HALF_PERIOD_MICROS    5
+
+/**
+ * Time budget of a bus reset: the SCL pulses, the STOP, the pin mode changes and
+ * restarting the Wire library. Boards with a slower Wire.begin() must raise it.
+ */
+#ifndef MAGNETOMETER_RECOVERY_RESET_MICROS
+#define MAGNETOMETER_RECOVERY_RESET_MICROS          400
+#endif
+
+/**
+ * A glitch on the bus (EMI, a brown out, a reset of the master in the middle of
+ * a transfer) leaves the sensor in one of a few bad states:
+ *
+ * <pre>
+ * - The transfer is short, so the sample buffer is only partially filled.
+ * - The slave still holds SDA low, waiting for clocks of a transfer the master
+ *   forgot. Every later transfer fails until it is released.
+ * - The data output registers are locked (LOCK bit) because the previous
+ *   sample was not read completely. The next complete read returns the old
+ *   sample and unlocks them.
+ * - The sensor was power cycled and lost its configuration (idle mode), so
+ *   the same sample is returned forever.
+ * </pre>
+ *
+ * This wrapper checks every transfer and recovers in escalating steps:
+ *
+ * <pre>
+ * Attempt 1 failed:    rewrite CRA, CRB and MR (writing MR also clears LOCK).
+ * Attempt 2.. failed:  bus reset (up to 9 SCL pulses and a STOP), rewrite the configuration.
+ * Last attempt failed: give up; readAxes() returns false and getHeading() the last good heading.
+ * </pre>
+ *
+ * When the sensor stops converting, complete reads keep returning the same
+ * sample. Past setStaleLimit() identical samples, the configuration is rewritten
+ * and the read reported as failed.
+ *
+ * The time spent in a read is bounded. Assuming the Wire library supports a
+ * transfer timeout T (WIRE_HAS_TIMEOUT, set by begin()), every transfer readAxes()
+ * makes is counted:
+ *
+ * <pre>
+ * Each attempt:        2 transfers (register pointer, then data).
+ * Each retry:          1 transfer (configuration), plus a bus reset R from the second one.
+ * Last attempt:        1 transfer (configuration) if its sample is stale.
+ * Worst case:          3 * (retries + 1) * T + max(retries - 1, 0) * R
+ * </pre>
+ *
+ * where R is MAGNETOMETER_RECOVERY_RESET_MICROS. getMaxLatency() returns this
+ * bound, 9 * T + R with the defaults. Without transfer timeout a slave holding
+ * SCL low can still block the Wire library forever; nothing can be done here.
+ */
+class MagnetometerRecovery: public Magnetometer {
+
+    MagnetometerHMC5883L *magnetometer;
+
+    /**
+     * CRA, CRB and MR values restored after a failure.
+     */
+    unsigned char configuration[3];
+
+    /**
+     * Last sample, to detect repeated samples.
+     */
+    int16_t last[3];
+
+    unsigned long timeout;
+    uint16_t staleLimit;
+    uint16_t staleCount;
+    uint16_t errors;
+    uint16_t recoveries;
+    unsigned char sdaPin;
+    unsigned char sclPin;
+    unsigned char retries;
+    unsigned char lastError;
+    bool configured;
+    double lastHeading;
+
+    bool isStale(int16_t x, int16_t y, int16_t z);
+
+public:
+
+    /**
+     * Why the last read failed.
+     */
+    enum Error {
+        NO_ERROR = 0x00,
+        TRANSFER_ERROR = 0x01,
+        STALE = 0x02
+    };
+
+    /**
+     * Public constructor, using the board SDA and SCL pins.
+     *
+     * @param magnetometer      The magnetometer to be watched.
+     */
+    MagnetometerRecovery(MagnetometerHMC5883L *magnetometer);
+
+    /**
+     * Public constructor.
+     *
+     * @param magnetometer      The magnetometer to be watched.
+     * @param sdaPin            Pin wired to SDA.
+     * @param sclPin            Pin wired to SCL.
+     */
+    MagnetometerRecovery(MagnetometerHMC5883L *magnetometer, unsigned char sdaPin, unsigned char sclPin);
+
+    /**
+     * Virtual destructor
+     */
+    virtual ~MagnetometerRecovery();
+
+    /**
+     * Captures the current configuration of the sensor as the one to be restored,
+     * and sets the Wire transfer timeout when supported.
+     *
+     * Must be called once the sensor is configured. Bits that must be written as 0
+     * are cleared. After a single measurement the mode register reads back as idle,
+     * so the capture is rejected; use setConfiguration() instead.
+     *
+     * @param timeout           Transfer timeout in microseconds.
+     * @return                  True if the configuration was read and the device is not idle.
+     */
+    bool begin(unsigned long timeout = MAGNETOMETER_RECOVERY_DEFAULT_TIMEOUT);
+
+    /**
+     * Sets the configuration to be restored, instead of capturing it.
+     *
+     * @param cra               Configuration register A.
+     * @param crb               Configuration register B.
+     * @param mr                Mode register.
+     */
+    void setConfiguration(unsigned char cra, unsigned char crb, unsigned char mr);
+
+    /**
+     * Sets how many times a failed read is retried, after a recovery step.
+     *
+     * @param retries           Retries, zero to only report failures.
+     */
+    void setMaxRetries(unsigned char retries);
+
+    /**
+     * Sets after how many identical consecutive samples the data output registers
+     * are considered stuck. The sensor noise makes identical
+     * samples very unlikely in continuous mode. Zero (default) disables the check.
+     *
+     * @param samples           Identical consecutive samples.
+     */
+    void setStaleLimit(uint16_t samples);
+
+    /**
+     * Releases a stuck bus: stops the Wire library, clocks SCL until the slave lets
+     * SDA go (at most 9 pulses), then generates a STOP and restarts the Wire library.
+     */
+    void resetBus();
+
+    /**
+     * Restores the sensor configuration, also clearing the LOCK bit.
+     *
+     * Nothing is written before begin() or setConfiguration().
+     *
+     * @param resetBus          True to reset the bus first.
+     */
+    void recover(bool resetBus);
+
+    /**
+     * Gets the worst case time spent in readAxes(), in microseconds.
+     */
+    unsigned long getMaxLatency();
+
+    /**
+     * Gets how many reads failed since the start, retries included.
+     */
+    uint16_t getErrorCount();
+
+    /**
+     * Gets how many recovery steps were performed since the start.
+     */
+    uint16_t getRecoveryCount();
+
+    /**
+     * Gets whether the last read succeeded.
+     */
+    bool isHealthy();
+
+    /**
+     * Gets why the last read failed.
+     *
+     * @return          NO_ERROR or an Error option.
+     */
+    unsigned char getLastError();
+
+    /**
+     * Reads the sample, retrying and recovering as needed.
+     *
+     * @return          True if a complete, fresh sample was read.
+     */
+    bool readAxes(int16_t &x, int16_t &y, int16_t &z);
+
+    /**
+     * Gets the heading in degree, or the last good one if the sample could not be read.
+     *
+     * @return          The heading, or NAN if no sample was read yet.
+     */
+    double getHeading();
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_RECOVERY_H__
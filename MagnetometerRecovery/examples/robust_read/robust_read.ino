@@ -0,0 +1,48 @@
+#include <Wire.h>
+#include <Magnetometer.h>
+#include <WiredDevice.h>
+#include <RegisterBasedWiredDevice.h>
+#include <MagnetometerHMC5883L.h>
+#include <MagnetometerRecovery.h>
+
+/**
+ * Pinout
+ *
+ * <pre>
+ * Sensor   -> Arduino
+ * -------------------
+ * SCL      -> A5
+ * SDA      -> A4
+ *
+ * VCC      -> 3v3
+ * GND      -> GND
+ * </pre>
+ */
+
+MagnetometerHMC5883L mag;
+MagnetometerRecovery recovery(&mag);
+
+void setup() {
+    Serial.begin(9600);
+    Wire.begin();
+    mag.setDataOutputRate(MagnetometerHMC5883L::DAR_15);
+    mag.setOperatingMode(MagnetometerHMC5883L::CONTINUOUS_MEASUREMENT_MODE);
+    recovery.begin();
+    recovery.setStaleLimit(16);
+    Serial.print("max latency (us): ");
+    Serial.println(recovery.getMaxLatency());
+}
+
+void loop() {
+    int16_t x, y, z;
+    if (recovery.readAxes(x, y, z)) {
+        Serial.print("heading: ");
+        Serial.println(Magnetometer::computeVectorAngle(x, y));
+    } else {
+        Serial.print("read failed, errors: ");
+        Serial.print(recovery.getErrorCount());
+        Serial.print(", recoveries: ");
+        Serial.println(recovery.getRecoveryCount());
+    }
+    delay(100);
+}
@@ -0,0 +1,123 @@
+#include "MagnetometerSnapshot.h"
+#include <EEPROM.h>
+
+MagnetometerSnapshot::MagnetometerSnapshot(int address)
+        : address(address) {
+    image.magic = 0;
+    image.version = 0;
+    image.crc = 0;
+}
+
+bool MagnetometerSnapshot::capture(MagnetometerHMC5883L *magnetometer, MagnetometerCalibration *calibration) {
+    if (!readConfiguration(magnetometer)) {
+        return false;
+    }
+    unsigned char operatingMode = image.configuration[2] & MAGNETOMETER_HMC5883L_MR_MASK;
+    if (operatingMode != MagnetometerHMC5883L::CONTINUOUS_MEASUREMENT_MODE
+            && operatingMode != MagnetometerHMC5883L::SINGLE_MEASUREMENT_MODE) {
+        return false;
+    }
+    seal(calibration);
+    return true;
+}
+
+bool MagnetometerSnapshot::capture(MagnetometerHMC5883L *magnetometer, MagnetometerCalibration *calibration,
+        unsigned char operatingMode) {
+    if (!readConfiguration(magnetometer)) {
+        return false;
+    }
+    image.configuration[2] = (image.configuration[2] & ~MAGNETOMETER_HMC5883L_MR_MASK)
+            | (operatingMode & MAGNETOMETER_HMC5883L_MR_MASK);
+    seal(calibration);
+    return true;
+}
+
+bool MagnetometerSnapshot::readConfiguration(MagnetometerHMC5883L *magnetometer) {
+
+    // Invalid until sealed.
+    image.magic = 0;
+    if (magnetometer->readConfiguration(image.configuration) != 3) {
+        return false;
+    }
+    magnetometer->maskConfiguration(image.configuration);
+    return true;
+}
+
+void MagnetometerSnapshot::seal(MagnetometerCalibration *calibration) {
+    if (calibration != 0) {
+        image.calibration = calibration->getParameters();
+    } else {
+        MagnetometerCalibration identity;
+        image.calibration = identity.getParameters();
+    }
+    image.magic = MAGNETOMETER_SNAPSHOT_MAGIC;
+    image.version = MAGNETOMETER_SNAPSHOT_VERSION;
+    image.crc = computeCrc();
+}
+
+bool MagnetometerSnapshot::restore(MagnetometerHMC5883L *magnetometer, MagnetometerCalibration *calibration) {
+    if (!isValid()) {
+        return false;
+    }
+    magnetometer->writeConfiguration(image.configuration);
+    if (calibration != 0) {
+        calibration->setParameters(image.calibration);
+    }
+    return true;
+}
+
+bool MagnetometerSnapshot::save() {
+    if (!isValid()) {
+        return false;
+    }
+    const unsigned char *p = (const unsigned char *) &image;
+    for (int i = 0; i < getSize(); i++) {
+        if (EEPROM.read(address + i) != p[i]) {
+            EEPROM.write(address + i, p[i]);
+        }
+    }
+
+    // Verify against the image in memory, without overwriting it.
+    for (int i = 0; i < getSize(); i++) {
+        if (EEPROM.read(address + i) != p[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MagnetometerSnapshot::load() {
+    unsigned char *p = (unsigned char *) &image;
+    for (int i = 0; i < getSize(); i++) {
+        p[i] = EEPROM.read(address + i);
+    }
+    return isValid();
+}
+
+bool MagnetometerSnapshot::isValid() {
+    return image.magic == MAGNETOMETER_SNAPSHOT_MAGIC && image.version == MAGNETOMETER_SNAPSHOT_VERSION
+            && image.crc == computeCrc();
+}
+
+MagnetometerSnapshot::Image &MagnetometerSnapshot::getImage() {
+    return image;
+}
+
+int MagnetometerSnapshot::getSize() {
+    return sizeof(Image);
+}
+
+uint16_t MagnetometerSnapshot::crc16(const unsigned char *buf, int len) {
+    uint16_t crc = 0xffff;
+    while (len-- > 0) {
+        crc ^= (uint16_t) *buf++ << 8;
+        for (unsigned char i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+uint16_t MagnetometerSnapshot::computeCrc() {
+    return crc16((const unsigned char *) &image, sizeof(Image) - sizeof(image.crc));
+}
@@ -0,0 +1,148 @@
+/**
+ * Arduino - MagnetometerSnapshot
+ *
+ * Persists the driver configuration and calibration into the EEPROM.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_SNAPSHOT_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_SNAPSHOT_H__ 1
+
+#include <MagnetometerHMC5883L.h>
+#include <MagnetometerCalibration.h>
+
+#define MAGNETOMETER_SNAPSHOT_MAGIC             0x4d53
+#define MAGNETOMETER_SNAPSHOT_VERSION           0x01
+
+/**
+ * A snapshot holds the configuration registers (CRA, CRB and MR) and the
+ * calibration parameters, tagged with a magic number and a version and protected
+ * by a CRC-16 (CCITT).
+ *
+ * A warm boot only needs to load the snapshot from the EEPROM and restore it,
+ * which writes the three configuration registers in a single burst. The first
+ * valid heading is then available after the sensor first conversion, without
+ * running every setter again nor re-deriving the calibration.
+ *
+ * <pre>
+ * if (snapshot.load()) {
+ *     snapshot.restore(&mag, &calibration);
+ * } else {
+ *     // configure and calibrate
+ *     snapshot.capture(&mag, &calibration);
+ *     snapshot.save();
+ * }
+ * </pre>
+ *
+ * Saving only writes the bytes that changed, to spare EEPROM write cycles.
+ * Platforms emulating the EEPROM in flash must still commit it after save().
+ */
+class MagnetometerSnapshot {
+
+public:
+
+    /**
+     * Snapshot image, as stored in the EEPROM.
+     */
+    struct Image {
+        uint16_t magic;
+        unsigned char version;
+        unsigned char configuration[3];
+        MagnetometerCalibration::Parameters calibration;
+        uint16_t crc;
+    };
+
+    /**
+     * Public constructor.
+     *
+     * @param address       EEPROM address where the snapshot lives.
+     */
+    MagnetometerSnapshot(int address);
+
+    /**
+     * Captures the current configuration from the device and the calibration.
+     *
+     * Bits that must be written as 0 are cleared. After a single measurement the mode
+     * register reads back as idle, which would restore the device idle, so the capture
+     * is rejected; use the overload taking the operating mode instead.
+     *
+     * @param magnetometer  The device.
+     * @param calibration   The calibration, or 0 to store the identity.
+     * @return              True if the configuration was read and the device is not idle.
+     */
+    bool capture(MagnetometerHMC5883L *magnetometer, MagnetometerCalibration *calibration);
+
+    /**
+     * Captures the current configuration from the device and the calibration,
+     * storing the given operating mode instead of the one read back.
+     *
+     * @param magnetometer  The device.
+     * @param calibration   The calibration, or 0 to store the identity.
+     * @param operatingMode OperatingMode option to restore.
+     * @return              True if the configuration was read.
+     */
+    bool capture(MagnetometerHMC5883L *magnetometer, MagnetometerCalibration *calibration, unsigned char operatingMode);
+
+    /**
+     * Restores the snapshot into the device and the calibration.
+     *
+     * @param magnetometer  The device.
+     * @param calibration   The calibration, or 0 to skip it.
+     * @return              False if there is no valid snapshot to restore.
+     */
+    bool restore(MagnetometerHMC5883L *magnetometer, MagnetometerCalibration *calibration);
+
+    /**
+     * Saves the snapshot into the EEPROM.
+     *
+     * The snapshot in memory is left untouched, so a failed save can be retried.
+     *
+     * @return              False if the snapshot is not valid or does not read back identical.
+     */
+    bool save();
+
+    /**
+     * Loads the snapshot from the EEPROM.
+     *
+     * @return              True if the stored image has the right magic, version and CRC.
+     */
+    bool load();
+
+    /**
+     * Gets whether the snapshot holds a valid image.
+     */
+    bool isValid();
+
+    /**
+     * Gets the snapshot image.
+     */
+    Image &getImage();
+
+    /**
+     * Gets the EEPROM space used by the snapshot.
+     */
+    static int getSize();
+
+    /**
+     * Computes the CRC-16 (CCITT, polynomial 0x1021, initial 0xffff) of a buffer.
+     *
+     * @param buf           Buffer.
+     * @param len           Buffer length.
+     * @return              The CRC.
+     */
+    static uint16_t crc16(const unsigned char *buf, int len);
+
+private:
+
+    int address;
+    Image image;
+
+    uint16_t computeCrc();
+
+    bool readConfiguration(MagnetometerHMC5883L *magnetometer);
+
+    void seal(MagnetometerCalibration *calibration);
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_SNAPSHOT_H__
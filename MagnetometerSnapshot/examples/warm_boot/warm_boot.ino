@@ -0,0 +1,52 @@
+#include <Wire.h>
+#include <EEPROM.h>
+#include <Magnetometer.h>
+#include <WiredDevice.h>
+#include <RegisterBasedWiredDevice.h>
+#include <MagnetometerHMC5883L.h>
+#include <MagnetometerCalibration.h>
+#include <MagnetometerSnapshot.h>
+
+/**
+ * Pinout
+ *
+ * <pre>
+ * Sensor   -> Arduino
+ * -------------------
+ * SCL      -> A5
+ * SDA      -> A4
+ *
+ * VCC      -> 3v3
+ * GND      -> GND
+ * </pre>
+ */
+
+MagnetometerHMC5883L mag;
+MagnetometerCalibration calibration;
+MagnetometerSnapshot snapshot(0);
+
+void setup() {
+    Serial.begin(9600);
+    if (snapshot.load()) {
+        snapshot.restore(&mag, &calibration);
+        Serial.println("Warm boot: snapshot restored.");
+    } else {
+        mag.setGain(MagnetometerHMC5883L::GAIN_1_3_GA);
+        mag.setDataOutputRate(MagnetometerHMC5883L::DAR_15);
+        mag.setOperatingMode(MagnetometerHMC5883L::CONTINUOUS_MEASUREMENT_MODE);
+        calibration.setOffset(-45, 120, 12);
+        snapshot.capture(&mag, &calibration);
+        Serial.print("Cold boot: snapshot saved: ");
+        Serial.println(snapshot.save());
+    }
+}
+
+void loop() {
+    int16_t x, y, z;
+    if (mag.readAxes(x, y, z)) {
+        calibration.apply(x, y, z);
+        Serial.print("heading: ");
+        Serial.println(Magnetometer::computeVectorAngle(x, y));
+    }
+    delay(1000);
+}
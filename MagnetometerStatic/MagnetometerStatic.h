@@ -0,0 +1,115 @@
+/**
+ * Arduino - MagnetometerStatic
+ *
+ * Header-only, devirtualized magnetometer driver.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_STATIC_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_STATIC_H__ 1
+
+#include <Magnetometer.h>
+#include <MagnetometerWireTransport.h>
+#include <MagnetometerStaticChips.h>
+
+/**
+ * The regular drivers derive from Magnetometer and RegisterBasedWiredDevice,
+ * which costs a vtable, an object in RAM and an indirect call per sample.
+ *
+ * This variant is a template on a transport and a chip description, with only
+ * static members: it holds no state, needs no instance and the compiler can
+ * inline the whole path from the bus read to the decoded vector.
+ *
+ * <pre>
+ * typedef MagnetometerStatic<MagnetometerWireTransport, MagnetometerHMC5883LChip> Compass;
+ *
+ * Compass::configure();
+ * double heading = Compass::getHeading();
+ * </pre>
+ *
+ * Code written against the Magnetometer interface can still use it through
+ * MagnetometerStaticAdapter, paying for the virtual call only there.
+ */
+template<class Transport, class Chip>
+class MagnetometerStatic {
+
+public:
+
+    /**
+     * Starts continuous measurements with the chip defaults.
+     */
+    static inline void configure() {
+        Chip::template configure<Transport>();
+    }
+
+    /**
+     * Writes a register.
+     *
+     * @param reg       Register.
+     * @param value     Value.
+     */
+    static inline void writeRegister(unsigned char reg, unsigned char value) {
+        Transport::write(Chip::ADDRESS, reg, value);
+    }
+
+    /**
+     * Reads a block of registers.
+     *
+     * @param reg       First register.
+     * @param buf       Where the bytes will be placed.
+     * @param len       Number of bytes.
+     * @return          The number of bytes read.
+     */
+    static inline int readRegisterBlock(unsigned char reg, unsigned char *buf, int len) {
+        return Transport::read(Chip::ADDRESS, reg, buf, len);
+    }
+
+    /**
+     * Reads the sample and decodes it into the three axes.
+     *
+     * @return          True if all 6 bytes were read.
+     */
+    static inline bool readAxes(int16_t &x, int16_t &y, int16_t &z) {
+        unsigned char buf[6] = {0};
+        int n = Transport::read(Chip::ADDRESS, Chip::DATA_REGISTER, buf, 6);
+        Chip::decode(buf, x, y, z);
+        return n == 6;
+    }
+
+    /**
+     * Gets the heading in degree, NAN if the sample could not be read.
+     */
+    static inline double getHeading() {
+        int16_t x = 0, y = 0, z = 0;
+        if (!readAxes(x, y, z)) {
+            return NAN;
+        }
+        return Magnetometer::computeVectorAngle(x, y);
+    }
+};
+
+/**
+ * Thin adapter exposing a static driver through the Magnetometer interface.
+ */
+template<class Driver>
+class MagnetometerStaticAdapter: public Magnetometer {
+
+public:
+
+    /**
+     * Gets the heading in degree.
+     */
+    double getHeading() {
+        return Driver::getHeading();
+    }
+
+    /**
+     * Reads the raw magnetic vector.
+     */
+    bool readAxes(int16_t &x, int16_t &y, int16_t &z) {
+        return Driver::readAxes(x, y, z);
+    }
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_STATIC_H__
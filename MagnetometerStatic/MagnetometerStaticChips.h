@@ -0,0 +1,95 @@
+/**
+ * Arduino - MagnetometerStaticChips
+ *
+ * Chip descriptions for the header-only magnetometer drivers.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_STATIC_CHIPS_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_STATIC_CHIPS_H__ 1
+
+#include <MagnetometerHMC5883L.h>
+#include <MagnetometerQMC5883L.h>
+#include <MagnetometerLIS3MDL.h>
+
+/**
+ * A chip description tells where the sample lives, how to decode it and how to
+ * start continuous measurements. Register addresses and values come from the
+ * regular drivers, so both variants always agree.
+ */
+
+/**
+ * HMC5883L (and HMC5983): X, Z, Y, MSB first.
+ */
+struct MagnetometerHMC5883LChip {
+
+    static const unsigned char ADDRESS = MAGNETOMETER_HMC5883L_DEVICE_ADDRESS;
+    static const unsigned char DATA_REGISTER = MagnetometerHMC5883L::DXRA;
+
+    static inline void decode(const unsigned char *buf, int16_t &x, int16_t &y, int16_t &z) {
+        x = (int16_t) ((buf[0] << 8) | buf[1]);
+        z = (int16_t) ((buf[2] << 8) | buf[3]);
+        y = (int16_t) ((buf[4] << 8) | buf[5]);
+    }
+
+    template<class Transport>
+    static inline void configure() {
+        MagnetometerHMC5883L::CRAbits cra = {0};
+        cra.DO = MagnetometerHMC5883L::DAR_75;
+        Transport::write(ADDRESS, MagnetometerHMC5883L::CRA, cra.value);
+        Transport::write(ADDRESS, MagnetometerHMC5883L::MR, MagnetometerHMC5883L::CONTINUOUS_MEASUREMENT_MODE);
+    }
+};
+
+/**
+ * QMC5883L: X, Y, Z, LSB first.
+ */
+struct MagnetometerQMC5883LChip {
+
+    static const unsigned char ADDRESS = MAGNETOMETER_QMC5883L_DEVICE_ADDRESS;
+    static const unsigned char DATA_REGISTER = MagnetometerQMC5883L::DXL;
+
+    static inline void decode(const unsigned char *buf, int16_t &x, int16_t &y, int16_t &z) {
+        x = (int16_t) ((buf[1] << 8) | buf[0]);
+        y = (int16_t) ((buf[3] << 8) | buf[2]);
+        z = (int16_t) ((buf[5] << 8) | buf[4]);
+    }
+
+    template<class Transport>
+    static inline void configure() {
+        MagnetometerQMC5883L::CR1bits cr1 = {0};
+        cr1.MODE = MagnetometerQMC5883L::CONTINUOUS_MEASUREMENT_MODE;
+        cr1.ODR = MagnetometerQMC5883L::DAR_200;
+        cr1.RNG = MagnetometerQMC5883L::RANGE_8_GA;
+        cr1.OSR = MagnetometerQMC5883L::OSR_512;
+        Transport::write(ADDRESS, MagnetometerQMC5883L::SRPR, MAGNETOMETER_QMC5883L_SET_RESET_PERIOD);
+        Transport::write(ADDRESS, MagnetometerQMC5883L::CR1, cr1.value);
+    }
+};
+
+/**
+ * LIS3MDL: X, Y, Z, LSB first, read with register auto increment.
+ */
+struct MagnetometerLIS3MDLChip {
+
+    static const unsigned char ADDRESS = MAGNETOMETER_LIS3MDL_DEVICE_ADDRESS;
+    static const unsigned char DATA_REGISTER = MagnetometerLIS3MDL::OUT_X_L | MAGNETOMETER_LIS3MDL_AUTO_INCREMENT;
+
+    static inline void decode(const unsigned char *buf, int16_t &x, int16_t &y, int16_t &z) {
+        x = (int16_t) ((buf[1] << 8) | buf[0]);
+        y = (int16_t) ((buf[3] << 8) | buf[2]);
+        z = (int16_t) ((buf[5] << 8) | buf[4]);
+    }
+
+    template<class Transport>
+    static inline void configure() {
+        Transport::write(ADDRESS, MagnetometerLIS3MDL::CTRL_REG1,
+                (MagnetometerLIS3MDL::HIGH_PERFORMANCE_MODE << 5) | (MagnetometerLIS3MDL::DAR_80 << 2));
+        Transport::write(ADDRESS, MagnetometerLIS3MDL::CTRL_REG4, MagnetometerLIS3MDL::HIGH_PERFORMANCE_MODE << 2);
+        Transport::write(ADDRESS, MagnetometerLIS3MDL::CTRL_REG5, MAGNETOMETER_LIS3MDL_CTRL5_BDU_MASK);
+        Transport::write(ADDRESS, MagnetometerLIS3MDL::CTRL_REG3, MagnetometerLIS3MDL::CONTINUOUS_MEASUREMENT_MODE);
+    }
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_STATIC_CHIPS_H__
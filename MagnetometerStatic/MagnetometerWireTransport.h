@@ -0,0 +1,58 @@
+/**
+ * Arduino - MagnetometerWireTransport
+ *
+ * Stateless I2C transport for the header-only magnetometer drivers.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_WIRE_TRANSPORT_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_WIRE_TRANSPORT_H__ 1
+
+#include <Wire.h>
+
+/**
+ * Transports only have static members, so a driver parameterized on them
+ * holds no state and every call can be inlined. Any class with the same two
+ * static functions (a software I2C, a SPI bridge, a mock) can replace it.
+ */
+struct MagnetometerWireTransport {
+
+    /**
+     * Reads a block of registers.
+     *
+     * @param address   Device address.
+     * @param reg       First register.
+     * @param buf       Where the bytes will be placed.
+     * @param len       Number of bytes.
+     * @return          The number of bytes read.
+     */
+    static inline int read(unsigned char address, unsigned char reg, unsigned char *buf, int len) {
+        Wire.beginTransmission(address);
+        Wire.write(reg);
+        if (Wire.endTransmission(false) != 0) {
+            return 0;
+        }
+        int n = Wire.requestFrom(address, (unsigned char) len);
+        for (int i = 0; i < n; i++) {
+            buf[i] = Wire.read();
+        }
+        return n;
+    }
+
+    /**
+     * Writes a register.
+     *
+     * @param address   Device address.
+     * @param reg       Register.
+     * @param value     Value.
+     */
+    static inline void write(unsigned char address, unsigned char reg, unsigned char value) {
+        Wire.beginTransmission(address);
+        Wire.write(reg);
+        Wire.write(value);
+        Wire.endTransmission();
+    }
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_WIRE_TRANSPORT_H__
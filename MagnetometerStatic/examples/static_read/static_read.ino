@@ -0,0 +1,39 @@
+#include <Wire.h>
+#include <Magnetometer.h>
+#include <WiredDevice.h>
+#include <RegisterBasedWiredDevice.h>
+#include <MagnetometerHMC5883L.h>
+#include <MagnetometerQMC5883L.h>
+#include <MagnetometerLIS3MDL.h>
+#include <MagnetometerStatic.h>
+
+/**
+ * Pinout
+ *
+ * <pre>
+ * Sensor   -> Arduino
+ * -------------------
+ * SCL      -> A5
+ * SDA      -> A4
+ *
+ * VCC      -> 3v3
+ * GND      -> GND
+ * </pre>
+ */
+
+typedef MagnetometerStatic<MagnetometerWireTransport, MagnetometerHMC5883LChip> Compass;
+
+void setup() {
+    Serial.begin(9600);
+    Wire.begin();
+    Compass::configure();
+}
+
+void loop() {
+    int16_t x, y, z;
+    if (Compass::readAxes(x, y, z)) {
+        Serial.print("heading: ");
+        Serial.println(Magnetometer::computeVectorAngle(x, y));
+    }
+    delay(1000);
+}
@@ -0,0 +1,153 @@
+#include "MagnetometerTask.h"
+#include <Arduino.h>
+
+MagnetometerTask *MagnetometerTask::readyTask = 0;
+
+MagnetometerTask::MagnetometerTask(MagnetometerHMC5883L *magnetometer, unsigned long period)
+        : magnetometer(magnetometer), period(period), conversion(MAGNETOMETER_TASK_CONVERSION_MICROS),
+          timeout(MAGNETOMETER_TASK_TIMEOUT_MICROS), triggeredAt(0), handler(0), context(0),
+          readyPin(MAGNETOMETER_TASK_NO_READY_PIN), state(CONFIGURE), dataReady(false) {
+    MagnetometerHMC5883L::CRAbits cra = {0};
+    MagnetometerHMC5883L::CRBbits crb = {0};
+    cra.MA = MagnetometerHMC5883L::SA_8;
+    cra.DO = MagnetometerHMC5883L::DAR_15;
+    crb.GN = MagnetometerHMC5883L::GAIN_1_3_GA;
+    configuration[0] = cra.value;
+    configuration[1] = crb.value;
+    configuration[2] = MagnetometerHMC5883L::SINGLE_MEASUREMENT_MODE;
+    sample[0] = sample[1] = sample[2] = 0;
+}
+
+void MagnetometerTask::setConfiguration(unsigned char cra, unsigned char crb) {
+    configuration[0] = cra;
+    configuration[1] = crb;
+}
+
+void MagnetometerTask::setHandler(SampleHandler handler, void *context) {
+    this->handler = handler;
+    this->context = context;
+}
+
+void MagnetometerTask::setReadyPin(unsigned char pin) {
+    if (readyPin != MAGNETOMETER_TASK_NO_READY_PIN) {
+        detachInterrupt(digitalPinToInterrupt(readyPin));
+        readyTask = 0;
+    }
+    readyPin = pin;
+    dataReady = false;
+    if (pin != MAGNETOMETER_TASK_NO_READY_PIN) {
+        readyTask = this;
+        pinMode(pin, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(pin), onDataReady, FALLING);
+    }
+}
+
+void MagnetometerTask::onDataReady() {
+    if (readyTask != 0) {
+        readyTask->dataReady = true;
+    }
+}
+
+void MagnetometerTask::setConversionTime(unsigned long conversion) {
+    this->conversion = conversion;
+}
+
+void MagnetometerTask::setTimeout(unsigned long timeout) {
+    this->timeout = timeout;
+}
+
+void MagnetometerTask::restart() {
+    state = CONFIGURE;
+}
+
+bool MagnetometerTask::isReady() {
+    if (readyPin != MAGNETOMETER_TASK_NO_READY_PIN) {
+        if (!dataReady) {
+            return false;
+        }
+        dataReady = false;
+        return true;
+    }
+    return magnetometer->getStatusRegister().RDY;
+}
+
+MagnetometerTask::Result MagnetometerTask::step() {
+    unsigned long now = micros();
+    switch (state) {
+    case CONFIGURE:
+
+        // Writing MR in single measurement mode also triggers the first measurement.
+        dataReady = false;
+        magnetometer->writeConfiguration(configuration);
+        triggeredAt = now;
+        state = WAIT_READY;
+        break;
+    case IDLE:
+        if (now - triggeredAt < period) {
+            break;
+        }
+        state = TRIGGER;
+
+        // The period elapsed, trigger right away.
+        // Fall through.
+    case TRIGGER:
+        dataReady = false;
+        magnetometer->setOperatingMode(MagnetometerHMC5883L::SINGLE_MEASUREMENT_MODE);
+        triggeredAt = now;
+        state = WAIT_READY;
+        break;
+    case WAIT_READY:
+        if (now - triggeredAt < conversion) {
+            break;
+        }
+        if (isReady()) {
+            state = READ;
+        } else if (now - triggeredAt >= timeout) {
+            state = CONFIGURE;
+            return TIMEOUT;
+        }
+        break;
+    case READ:
+        if (!magnetometer->readAxes(sample[0], sample[1], sample[2])) {
+            state = CONFIGURE;
+            return READ_ERROR;
+        }
+        state = PROCESS;
+        break;
+    case PROCESS:
+        state = IDLE;
+        if (handler != 0) {
+            handler(sample[0], sample[1], sample[2], context);
+        }
+#ifdef MAGNETOMETER_TASK_COROUTINES
+        if (waiter) {
+            std::coroutine_handle<> handle = waiter;
+            waiter = nullptr;
+            handle.resume();
+        }
+#endif
+        return SAMPLE_READY;
+    }
+    return PENDING;
+}
+
+MagnetometerTask::State MagnetometerTask::getState() {
+    return state;
+}
+
+unsigned long MagnetometerTask::getWaitMicros() {
+    unsigned long elapsed = micros() - triggeredAt;
+    if (state == IDLE && elapsed < period) {
+        return period - elapsed;
+    }
+    if (state == WAIT_READY && elapsed < conversion) {
+        return conversion - elapsed;
+    }
+    return 0;
+}
+
+void MagnetometerTask::getSample(int16_t &x, int16_t &y, int16_t &z) {
+    x = sample[0];
+    y = sample[1];
+    z = sample[2];
+}
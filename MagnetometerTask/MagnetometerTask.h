@@ -0,0 +1,224 @@
+/**
+ * Arduino - MagnetometerTask
+ *
+ * Resumable, non-blocking acquisition task for the HMC5883L family.
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#ifndef __ARDUINO_DRIVER_MAGNETOMETER_TASK_H__
+#define __ARDUINO_DRIVER_MAGNETOMETER_TASK_H__ 1
+
+#include <MagnetometerHMC5883L.h>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define MAGNETOMETER_TASK_COROUTINES 1
+#endif
+#endif
+
+#define MAGNETOMETER_TASK_CONVERSION_MICROS     6000UL
+#define MAGNETOMETER_TASK_TIMEOUT_MICROS        50000UL
+#define MAGNETOMETER_TASK_NO_READY_PIN          0xff
+
+/**
+ * Instead of a blocking loop with a delay between reads, the acquisition is
+ * split into steps:
+ *
+ * <pre>
+ * CONFIGURE -> WAIT_READY -> READ -> PROCESS -> IDLE -> TRIGGER -> WAIT_READY -> ...
+ * </pre>
+ *
+ * Each call to step() advances at most one state and does at most one short
+ * bus transaction, so it never blocks. Measurements are triggered in single
+ * measurement mode at the task period; the ready flag is only checked once
+ * the conversion time has elapsed, from the DRDY pin when one is given, or
+ * from the status register otherwise.
+ *
+ * DRDY is pulled high and only goes low for 250us when new data is placed in
+ * the data output registers, which polling would miss. Its falling edge is
+ * latched by an interrupt instead, so the pin must be interrupt capable and
+ * only one task may use a DRDY pin. getWaitMicros() tells a scheduler how
+ * long it may run other tasks or sleep before the next useful step.
+ *
+ * <pre>
+ * void loop() {
+ *     task.step();
+ *     otherTask.step();
+ * }
+ * </pre>
+ *
+ * On compilers with C++20 coroutines, a coroutine can also co_await nextSample();
+ * it is resumed from step() once the sample was processed.
+ */
+class MagnetometerTask {
+
+public:
+
+    /**
+     * Acquisition states.
+     */
+    enum State {
+        CONFIGURE = 0x00,
+        IDLE = 0x01,
+        TRIGGER = 0x02,
+        WAIT_READY = 0x03,
+        READ = 0x04,
+        PROCESS = 0x05
+    };
+
+    /**
+     * What a step produced.
+     */
+    enum Result {
+        PENDING = 0x00,
+        SAMPLE_READY = 0x01,
+        TIMEOUT = 0x02,
+        READ_ERROR = 0x03
+    };
+
+    /**
+     * Called from step() for every sample read.
+     */
+    typedef void (*SampleHandler)(int16_t x, int16_t y, int16_t z, void *context);
+
+    /**
+     * Public constructor.
+     *
+     * @param magnetometer      The device.
+     * @param period            Time between measurements in microseconds.
+     */
+    MagnetometerTask(MagnetometerHMC5883L *magnetometer, unsigned long period);
+
+    /**
+     * Sets the configuration written at the CONFIGURE step.
+     * Defaults to 8 samples averaged and the default gain.
+     *
+     * @param cra               Configuration register A.
+     * @param crb               Configuration register B.
+     */
+    void setConfiguration(unsigned char cra, unsigned char crb);
+
+    /**
+     * Sets the handler called for every sample.
+     *
+     * @param handler           Handler.
+     * @param context           Passed back to the handler.
+     */
+    void setHandler(SampleHandler handler, void *context);
+
+    /**
+     * Uses the DRDY pin instead of the status register to know when data is ready.
+     *
+     * Attaches an interrupt to the falling edge of the pin.
+     *
+     * @param pin               Interrupt capable pin, MAGNETOMETER_TASK_NO_READY_PIN to use the status register.
+     */
+    void setReadyPin(unsigned char pin);
+
+    /**
+     * Sets the conversion time, before which the ready flag is not checked.
+     *
+     * @param conversion        Microseconds.
+     */
+    void setConversionTime(unsigned long conversion);
+
+    /**
+     * Sets the time after which a measurement that never got ready restarts the task from CONFIGURE.
+     *
+     * @param timeout           Microseconds.
+     */
+    void setTimeout(unsigned long timeout);
+
+    /**
+     * Restarts from CONFIGURE.
+     */
+    void restart();
+
+    /**
+     * Advances the task by one state at most.
+     *
+     * @return                  What the step produced.
+     */
+    Result step();
+
+    /**
+     * Gets the current state.
+     */
+    State getState();
+
+    /**
+     * Gets how long, in microseconds, the next step will have nothing to do.
+     */
+    unsigned long getWaitMicros();
+
+    /**
+     * Gets the last sample read.
+     */
+    void getSample(int16_t &x, int16_t &y, int16_t &z);
+
+#ifdef MAGNETOMETER_TASK_COROUTINES
+
+    /**
+     * Awaitable completing when the next sample was processed.
+     */
+    struct SampleAwaiter {
+
+        MagnetometerTask *task;
+
+        bool await_ready() {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            task->waiter = handle;
+        }
+
+        void await_resume() {
+        }
+    };
+
+    /**
+     * Gets an awaitable for the next sample.
+     */
+    SampleAwaiter nextSample() {
+        return SampleAwaiter{this};
+    }
+
+#endif
+
+private:
+
+    MagnetometerHMC5883L *magnetometer;
+    unsigned long period;
+    unsigned long conversion;
+    unsigned long timeout;
+    unsigned long triggeredAt;
+    SampleHandler handler;
+    void *context;
+    unsigned char configuration[3];
+    unsigned char readyPin;
+    State state;
+    int16_t sample[3];
+
+#ifdef MAGNETOMETER_TASK_COROUTINES
+    std::coroutine_handle<> waiter;
+#endif
+
+    /**
+     * Set by the DRDY falling edge interrupt.
+     */
+    volatile bool dataReady;
+
+    /**
+     * The task whose DRDY pin is attached to the interrupt.
+     */
+    static MagnetometerTask *readyTask;
+
+    static void onDataReady();
+
+    bool isReady();
+};
+
+#endif // __ARDUINO_DRIVER_MAGNETOMETER_TASK_H__
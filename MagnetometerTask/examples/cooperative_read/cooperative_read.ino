@@ -0,0 +1,51 @@
+#include <Wire.h>
+#include <Magnetometer.h>
+#include <WiredDevice.h>
+#include <RegisterBasedWiredDevice.h>
+#include <MagnetometerHMC5883L.h>
+#include <MagnetometerTask.h>
+
+/**
+ * Pinout
+ *
+ * <pre>
+ * Sensor   -> Arduino
+ * -------------------
+ * SCL      -> A5
+ * SDA      -> A4
+ * DRDY     -> 2
+ *
+ * VCC      -> 3v3
+ * GND      -> GND
+ * </pre>
+ */
+
+MagnetometerHMC5883L mag;
+MagnetometerTask task(&mag, 100000UL);
+
+unsigned long blinkedAt = 0;
+bool led = false;
+
+void printHeading(int16_t x, int16_t y, int16_t z, void *context) {
+    Serial.print("heading: ");
+    Serial.println(Magnetometer::computeVectorAngle(x, y));
+}
+
+void setup() {
+    Serial.begin(9600);
+    Wire.begin();
+    pinMode(LED_BUILTIN, OUTPUT);
+    task.setReadyPin(2);
+    task.setHandler(printHeading, 0);
+}
+
+void loop() {
+
+    // The acquisition never blocks, so other work keeps its own timing.
+    task.step();
+    if (millis() - blinkedAt >= 500) {
+        blinkedAt = millis();
+        led = !led;
+        digitalWrite(LED_BUILTIN, led ? HIGH : LOW);
+    }
+}
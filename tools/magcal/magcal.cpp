@@ -0,0 +1,554 @@
+/**
+ * magcal - offline magnetometer calibration and accuracy analysis
+ *
+ * Fits hard and soft iron parameters to a log of raw X/Y/Z samples, reports the
+ * field magnitude and heading errors obtained with them, and exports them as a
+ * MagnetometerCalibration::Parameters initializer the firmware can load.
+ *
+ * The log is a text file, one sample per line:
+ *
+ * <pre>
+ * x y z [reference heading in degrees]
+ * </pre>
+ *
+ * Fields may be separated by spaces, tabs or commas; lines starting with '#' or
+ * not starting with a number are skipped. When a reference heading is given,
+ * heading errors are reported before and after calibration.
+ *
+ * The file is mapped in memory and split into one chunk per thread. Each thread
+ * accumulates its own normal equations of the ellipsoid least squares fit, then
+ * the partial sums are added and solved once. A second parallel pass applies the
+ * integer calibration exactly as the firmware does (MagnetometerCalibration and
+ * Magnetometer::computeVectorAngle are compiled from the library sources).
+ *
+ * Usage: magcal [-j threads] [-o output.h] log
+ *
+ * @author Dalmir da Silva <dalmirdasilva@gmail.com>
+ */
+
+#include <Magnetometer.h>
+#include <MagnetometerCalibration.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <thread>
+#include <vector>
+
+/**
+ * Raw values are scaled down before fitting to keep the normal equations well conditioned.
+ */
+#define MAGCAL_SCALE        1024.0
+
+#define MAGCAL_UNKNOWNS     9
+
+struct Sample {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+    bool hasReference;
+    double reference;
+};
+
+/**
+ * Minimal parser over a memory mapped, not NUL terminated, buffer.
+ */
+class LineParser {
+
+    const char *p;
+    const char *end;
+
+    void skipSeparators() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == ',' || *p == '\r')) {
+            p++;
+        }
+    }
+
+    bool parseNumber(double &value) {
+        skipSeparators();
+        const char *start = p;
+        bool negative = false;
+        double integer = 0.0, fraction = 0.0, scale = 1.0;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p++ == '-';
+        }
+        while (p < end && *p >= '0' && *p <= '9') {
+            integer = integer * 10.0 + (*p++ - '0');
+        }
+        if (p < end && *p == '.') {
+            p++;
+            while (p < end && *p >= '0' && *p <= '9') {
+                scale *= 0.1;
+                fraction += (*p++ - '0') * scale;
+            }
+        }
+        if (p == start || (p == start + 1 && (*start == '-' || *start == '+'))) {
+            return false;
+        }
+        value = negative ? -(integer + fraction) : integer + fraction;
+        return true;
+    }
+
+    void skipLine() {
+        const char *newline = (const char *) memchr(p, '\n', end - p);
+        p = newline ? newline + 1 : end;
+    }
+
+public:
+
+    LineParser(const char *begin, const char *end)
+            : p(begin), end(end) {
+    }
+
+    /**
+     * Parses the next valid sample.
+     *
+     * @return      False at the end of the buffer.
+     */
+    bool next(Sample &sample) {
+        while (p < end) {
+            double x, y, z, reference;
+            bool valid = parseNumber(x) && parseNumber(y) && parseNumber(z);
+            if (valid) {
+                sample.hasReference = parseNumber(reference);
+                sample.reference = sample.hasReference ? reference : 0.0;
+            }
+            skipLine();
+            if (valid && fabs(x) <= 32767 && fabs(y) <= 32767 && fabs(z) <= 32767) {
+                sample.x = (int16_t) x;
+                sample.y = (int16_t) y;
+                sample.z = (int16_t) z;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+/**
+ * Normal equations of the fit A x² + B y² + C z² + 2D xy + 2E xz + 2F yz + 2G x + 2H y + 2I z = 1.
+ */
+struct NormalEquations {
+
+    double ata[MAGCAL_UNKNOWNS][MAGCAL_UNKNOWNS];
+    double atb[MAGCAL_UNKNOWNS];
+    unsigned long count;
+
+    NormalEquations() {
+        memset(this, 0, sizeof(*this));
+    }
+
+    void add(const Sample &s) {
+        double x = s.x / MAGCAL_SCALE, y = s.y / MAGCAL_SCALE, z = s.z / MAGCAL_SCALE;
+        double row[MAGCAL_UNKNOWNS] = {x * x, y * y, z * z, 2 * x * y, 2 * x * z, 2 * y * z, 2 * x, 2 * y, 2 * z};
+        for (int i = 0; i < MAGCAL_UNKNOWNS; i++) {
+            for (int j = i; j < MAGCAL_UNKNOWNS; j++) {
+                ata[i][j] += row[i] * row[j];
+            }
+            atb[i] += row[i];
+        }
+        count++;
+    }
+
+    void merge(const NormalEquations &other) {
+        for (int i = 0; i < MAGCAL_UNKNOWNS; i++) {
+            for (int j = i; j < MAGCAL_UNKNOWNS; j++) {
+                ata[i][j] += other.ata[i][j];
+            }
+            atb[i] += other.atb[i];
+        }
+        count += other.count;
+    }
+
+    /**
+     * Solves by Gaussian elimination with partial pivoting.
+     */
+    bool solve(double v[MAGCAL_UNKNOWNS]) {
+        double m[MAGCAL_UNKNOWNS][MAGCAL_UNKNOWNS + 1];
+        for (int i = 0; i < MAGCAL_UNKNOWNS; i++) {
+            for (int j = 0; j < MAGCAL_UNKNOWNS; j++) {
+                m[i][j] = j >= i ? ata[i][j] : ata[j][i];
+            }
+            m[i][MAGCAL_UNKNOWNS] = atb[i];
+        }
+        for (int c = 0; c < MAGCAL_UNKNOWNS; c++) {
+            int pivot = c;
+            for (int r = c + 1; r < MAGCAL_UNKNOWNS; r++) {
+                if (fabs(m[r][c]) > fabs(m[pivot][c])) {
+                    pivot = r;
+                }
+            }
+            if (fabs(m[pivot][c]) < 1e-12) {
+                return false;
+            }
+            for (int j = 0; j <= MAGCAL_UNKNOWNS; j++) {
+                double t = m[c][j];
+                m[c][j] = m[pivot][j];
+                m[pivot][j] = t;
+            }
+            for (int r = 0; r < MAGCAL_UNKNOWNS; r++) {
+                if (r != c) {
+                    double f = m[r][c] / m[c][c];
+                    for (int j = c; j <= MAGCAL_UNKNOWNS; j++) {
+                        m[r][j] -= f * m[c][j];
+                    }
+                }
+            }
+        }
+        for (int i = 0; i < MAGCAL_UNKNOWNS; i++) {
+            v[i] = m[i][MAGCAL_UNKNOWNS] / m[i][i];
+        }
+        return true;
+    }
+};
+
+/**
+ * Running error statistics.
+ */
+struct Statistics {
+
+    unsigned long count;
+    double sum;
+    double sumSquares;
+    double maximum;
+
+    Statistics()
+            : count(0), sum(0.0), sumSquares(0.0), maximum(0.0) {
+    }
+
+    void add(double error) {
+        count++;
+        sum += error;
+        sumSquares += error * error;
+        if (fabs(error) > maximum) {
+            maximum = fabs(error);
+        }
+    }
+
+    void merge(const Statistics &other) {
+        count += other.count;
+        sum += other.sum;
+        sumSquares += other.sumSquares;
+        if (other.maximum > maximum) {
+            maximum = other.maximum;
+        }
+    }
+
+    void print(const char *name, const char *unit) {
+        if (count == 0) {
+            return;
+        }
+        printf("%-28s mean %9.4f  rms %9.4f  max %9.4f %s\n", name, sum / count, sqrt(sumSquares / count), maximum,
+                unit);
+    }
+};
+
+struct Analysis {
+
+    Statistics magnitude;
+    Statistics rawHeading;
+    Statistics calibratedHeading;
+
+    void merge(const Analysis &other) {
+        magnitude.merge(other.magnitude);
+        rawHeading.merge(other.rawHeading);
+        calibratedHeading.merge(other.calibratedHeading);
+    }
+};
+
+/**
+ * Eigen decomposition of a symmetric 3x3 matrix by Jacobi rotations.
+ */
+static void decompose(double a[3][3], double values[3], double vectors[3][3]) {
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            vectors[i][j] = i == j ? 1.0 : 0.0;
+        }
+    }
+    for (int sweep = 0; sweep < 50; sweep++) {
+        double off = fabs(a[0][1]) + fabs(a[0][2]) + fabs(a[1][2]);
+        if (off < 1e-15) {
+            break;
+        }
+        for (int p = 0; p < 2; p++) {
+            for (int q = p + 1; q < 3; q++) {
+                if (fabs(a[p][q]) < 1e-300) {
+                    continue;
+                }
+                double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                double t = (theta >= 0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+                double c = 1.0 / sqrt(t * t + 1.0), s = t * c;
+                for (int k = 0; k < 3; k++) {
+                    double akp = a[k][p], akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < 3; k++) {
+                    double apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < 3; k++) {
+                    double vkp = vectors[k][p], vkq = vectors[k][q];
+                    vectors[k][p] = c * vkp - s * vkq;
+                    vectors[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        values[i] = a[i][i];
+    }
+}
+
+/**
+ * Turns the quadric coefficients into an offset and a soft iron matrix preserving the mean field radius.
+ */
+static bool computeParameters(const double v[MAGCAL_UNKNOWNS], double offset[3], double matrix[3][3], double &radius) {
+    double m[3][3] = {{v[0], v[3], v[4]}, {v[3], v[1], v[5]}, {v[4], v[5], v[2]}};
+    double b[3] = {v[6], v[7], v[8]};
+    double det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+            + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    if (fabs(det) < 1e-30) {
+        return false;
+    }
+    double inverse[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            int i1 = (j + 1) % 3, i2 = (j + 2) % 3, j1 = (i + 1) % 3, j2 = (i + 2) % 3;
+            inverse[i][j] = (m[i1][j1] * m[i2][j2] - m[i1][j2] * m[i2][j1]) / det;
+        }
+    }
+    double center[3], k = 1.0;
+    for (int i = 0; i < 3; i++) {
+        center[i] = -(inverse[i][0] * b[0] + inverse[i][1] * b[1] + inverse[i][2] * b[2]);
+    }
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            k += center[i] * m[i][j] * center[j];
+        }
+    }
+    if (k <= 0) {
+        return false;
+    }
+    double normalized[3][3], values[3], vectors[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            normalized[i][j] = m[i][j] / k;
+        }
+    }
+    decompose(normalized, values, vectors);
+    if (values[0] <= 0 || values[1] <= 0 || values[2] <= 0) {
+        return false;
+    }
+
+    // Geometric mean of the ellipsoid radii, so the corrected field keeps its magnitude.
+    radius = pow(values[0] * values[1] * values[2], -1.0 / 6.0);
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            double sum = 0.0;
+            for (int e = 0; e < 3; e++) {
+                sum += vectors[i][e] * sqrt(values[e]) * vectors[j][e];
+            }
+            matrix[i][j] = radius * sum;
+        }
+        offset[i] = center[i] * MAGCAL_SCALE;
+    }
+    radius *= MAGCAL_SCALE;
+    return true;
+}
+
+static int16_t roundToInt16(double value) {
+    value = value < 0 ? value - 0.5 : value + 0.5;
+    if (value > 32767) {
+        return 32767;
+    }
+    if (value < -32768) {
+        return -32768;
+    }
+    return (int16_t) value;
+}
+
+/**
+ * Signed difference of two headings, in (-180, 180].
+ */
+static double headingDifference(double a, double b) {
+    double d = fmod(a - b, 360.0);
+    if (d > 180.0) {
+        d -= 360.0;
+    } else if (d <= -180.0) {
+        d += 360.0;
+    }
+    return d;
+}
+
+static void accumulate(const char *begin, const char *end, NormalEquations *equations) {
+    LineParser parser(begin, end);
+    Sample sample;
+    while (parser.next(sample)) {
+        equations->add(sample);
+    }
+}
+
+static void analyze(const char *begin, const char *end, MagnetometerCalibration calibration, double radius,
+        Analysis *analysis) {
+    LineParser parser(begin, end);
+    Sample sample;
+    while (parser.next(sample)) {
+        int16_t x = sample.x, y = sample.y, z = sample.z;
+        if (sample.hasReference) {
+            analysis->rawHeading.add(headingDifference(Magnetometer::computeVectorAngle(x, y), sample.reference));
+        }
+        calibration.apply(x, y, z);
+        double magnitude = sqrt((double) x * x + (double) y * y + (double) z * z);
+        analysis->magnitude.add((magnitude / radius - 1.0) * 100.0);
+        if (sample.hasReference) {
+            analysis->calibratedHeading.add(
+                    headingDifference(Magnetometer::computeVectorAngle(x, y), sample.reference));
+        }
+    }
+}
+
+/**
+ * Splits the buffer in chunks ending on line boundaries.
+ */
+static std::vector<const char *> split(const char *data, size_t size, unsigned threads) {
+    std::vector<const char *> bounds;
+    bounds.push_back(data);
+    for (unsigned i = 1; i < threads; i++) {
+        const char *p = data + size * i / threads;
+        if (p < bounds.back()) {
+            p = bounds.back();
+        }
+        const char *newline = (const char *) memchr(p, '\n', data + size - p);
+        bounds.push_back(newline ? newline + 1 : data + size);
+    }
+    bounds.push_back(data + size);
+    return bounds;
+}
+
+static void usage() {
+    fprintf(stderr, "Usage: magcal [-j threads] [-o output.h] log\n");
+    exit(2);
+}
+
+static void writeParameters(FILE *out, const MagnetometerCalibration::Parameters &p) {
+    fprintf(out, "// Generated by magcal.\n");
+    fprintf(out, "const MagnetometerCalibration::Parameters MAGNETOMETER_CALIBRATION_PARAMETERS = {\n");
+    fprintf(out, "    {%d, %d, %d},\n", p.offset[0], p.offset[1], p.offset[2]);
+    fprintf(out, "    {%d, %d, %d,\n     %d, %d, %d,\n     %d, %d, %d}\n", p.matrix[0], p.matrix[1], p.matrix[2],
+            p.matrix[3], p.matrix[4], p.matrix[5], p.matrix[6], p.matrix[7], p.matrix[8]);
+    fprintf(out, "};\n");
+}
+
+int main(int argc, char **argv) {
+    unsigned threads = std::thread::hardware_concurrency();
+    const char *output = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:o:h")) != -1) {
+        switch (opt) {
+        case 'j':
+            threads = (unsigned) atoi(optarg);
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind != argc - 1) {
+        usage();
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    int fd = open(argv[optind], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "magcal: %s: %s\n", argv[optind], strerror(errno));
+        return 1;
+    }
+    if (st.st_size == 0) {
+        fprintf(stderr, "magcal: %s: empty log\n", argv[optind]);
+        return 1;
+    }
+    const char *data = (const char *) mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "magcal: %s: %s\n", argv[optind], strerror(errno));
+        return 1;
+    }
+    madvise((void *) data, st.st_size, MADV_SEQUENTIAL);
+    std::vector<const char *> bounds = split(data, st.st_size, threads);
+
+    std::vector<NormalEquations> partials(threads);
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; i++) {
+        workers.push_back(std::thread(accumulate, bounds[i], bounds[i + 1], &partials[i]));
+    }
+    NormalEquations equations;
+    for (unsigned i = 0; i < threads; i++) {
+        workers[i].join();
+        equations.merge(partials[i]);
+    }
+    workers.clear();
+
+    double v[MAGCAL_UNKNOWNS], offset[3], matrix[3][3], radius;
+    if (equations.count < MAGCAL_UNKNOWNS || !equations.solve(v) || !computeParameters(v, offset, matrix, radius)) {
+        fprintf(stderr, "magcal: cannot fit an ellipsoid to %lu samples; rotate the sensor through all orientations\n",
+                equations.count);
+        return 1;
+    }
+
+    MagnetometerCalibration::Parameters parameters;
+    for (int i = 0; i < 3; i++) {
+        parameters.offset[i] = roundToInt16(offset[i]);
+        for (int j = 0; j < 3; j++) {
+            parameters.matrix[i * 3 + j] = roundToInt16(matrix[i][j] * MAGNETOMETER_CALIBRATION_ONE);
+        }
+    }
+    MagnetometerCalibration calibration;
+    calibration.setParameters(parameters);
+
+    std::vector<Analysis> analyses(threads);
+    for (unsigned i = 0; i < threads; i++) {
+        workers.push_back(std::thread(analyze, bounds[i], bounds[i + 1], calibration, radius, &analyses[i]));
+    }
+    Analysis analysis;
+    for (unsigned i = 0; i < threads; i++) {
+        workers[i].join();
+        analysis.merge(analyses[i]);
+    }
+    munmap((void *) data, st.st_size);
+    close(fd);
+
+    printf("samples: %lu, threads: %u\n", equations.count, threads);
+    printf("hard iron offset: %.2f %.2f %.2f\n", offset[0], offset[1], offset[2]);
+    printf("soft iron matrix:\n");
+    for (int i = 0; i < 3; i++) {
+        printf("    %9.6f %9.6f %9.6f\n", matrix[i][0], matrix[i][1], matrix[i][2]);
+    }
+    printf("field radius: %.2f\n", radius);
+    analysis.magnitude.print("magnitude error", "%");
+    analysis.rawHeading.print("heading error (raw)", "deg");
+    analysis.calibratedHeading.print("heading error (calibrated)", "deg");
+
+    FILE *out = stdout;
+    if (output != 0 && (out = fopen(output, "w")) == 0) {
+        fprintf(stderr, "magcal: %s: %s\n", output, strerror(errno));
+        return 1;
+    }
+    writeParameters(out, parameters);
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}